@@ -0,0 +1,112 @@
+/*
+ * BenchAllocations.hpp - counting of the heap allocations of a benchmark.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_BENCH_ALLOCATIONS_HPP
+#define EDITOR_BENCH_ALLOCATIONS_HPP
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Note: the header replaces every form of the global operator new and delete, so it must be included by one file of a benchmark.
+
+/// The count of calls to operator new, of all its forms.
+static std::atomic<size_t> g_Allocations(0);
+
+/// Count and allocate a block of the size, aligned to the alignment if it is not 0. Return nullptr if there is no memory.
+static void* AllocateCounted(size_t size, size_t alignment = 0)
+{
+	g_Allocations++;
+	if (size == 0)
+	{
+		size = 1;
+	}
+
+	if (alignment == 0)
+	{
+		return std::malloc(size);
+	}
+
+	// std::aligned_alloc needs the size to be a multiple of the alignment.
+	return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+/// Count and allocate a block, throw std::bad_alloc if there is no memory.
+static void* AllocateCountedOrThrow(size_t size, size_t alignment = 0)
+{
+	void* block = AllocateCounted(size, alignment);
+	if (block == nullptr)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void* operator new(size_t size)
+{ return AllocateCountedOrThrow(size); }
+
+void* operator new[](size_t size)
+{ return AllocateCountedOrThrow(size); }
+
+void* operator new(size_t size, std::align_val_t alignment)
+{ return AllocateCountedOrThrow(size, static_cast<size_t>(alignment)); }
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{ return AllocateCountedOrThrow(size, static_cast<size_t>(alignment)); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{ return AllocateCounted(size); }
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{ return AllocateCounted(size); }
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{ return AllocateCounted(size, static_cast<size_t>(alignment)); }
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{ return AllocateCounted(size, static_cast<size_t>(alignment)); }
+
+// All the blocks are from std::malloc or std::aligned_alloc, so every form of delete frees them the same way.
+
+void operator delete(void* block) noexcept
+{ std::free(block); }
+
+void operator delete[](void* block) noexcept
+{ std::free(block); }
+
+void operator delete(void* block, size_t) noexcept
+{ std::free(block); }
+
+void operator delete[](void* block, size_t) noexcept
+{ std::free(block); }
+
+void operator delete(void* block, std::align_val_t) noexcept
+{ std::free(block); }
+
+void operator delete[](void* block, std::align_val_t) noexcept
+{ std::free(block); }
+
+void operator delete(void* block, size_t, std::align_val_t) noexcept
+{ std::free(block); }
+
+void operator delete[](void* block, size_t, std::align_val_t) noexcept
+{ std::free(block); }
+
+void operator delete(void* block, const std::nothrow_t&) noexcept
+{ std::free(block); }
+
+void operator delete[](void* block, const std::nothrow_t&) noexcept
+{ std::free(block); }
+
+void operator delete(void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{ std::free(block); }
+
+void operator delete[](void* block, std::align_val_t, const std::nothrow_t&) noexcept
+{ std::free(block); }
+
+#endif // EDITOR_BENCH_ALLOCATIONS_HPP
@@ -0,0 +1,78 @@
+/*
+ * HighlightBench.cpp - the speed of the syntax highlighter in tokens per second.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Highlight.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+/// The count of generated lines.
+#define BENCH_LINES 200000
+/// The count of passes over the lines.
+#define BENCH_PASSES 10
+
+/// The tokens the lines are made of: keywords, types, identifiers, numbers, strings and comments.
+static const char* const g_Tokens[] =
+{
+	"if", "while", "return", "static_cast", "constexpr", "namespace", "template", "typename",
+	"int", "unsigned", "void", "size_t", "char32_t",
+	"buffer", "m_Offset", "HighlightRows", "x", "iterator", "reinterpret", "whiles",
+	"42", "0x1F", "3.14f", "\"text\"", "'c'", "/* note */", "=", "(", ")", ";", "{", "}",
+};
+
+int main()
+{
+	const HighlightSyntax* syntax = FindHighlightSyntax("bench.cpp");
+	if (syntax == nullptr)
+	{
+		fprintf(stderr, "No syntax for .cpp files\n");
+		return 1;
+	}
+
+	std::mt19937 random(1);
+	std::vector<std::string> lines(BENCH_LINES);
+	size_t tokens = 0, bytes = 0, longest = 0;
+	for (std::string& line : lines)
+	{
+		line = "\t";
+		for (int count = random() % 12 + 1; count > 0; count--, tokens++)
+		{
+			line += g_Tokens[random() % (sizeof(g_Tokens) / sizeof(g_Tokens[0]))];
+			line += ' ';
+		}
+
+		bytes += line.size();
+		longest = line.size() > longest ? line.size() : longest;
+	}
+
+	// The styles are written in place, as the editor does, so the loop itself does not allocate.
+	std::vector<HighlightStyle> styles(longest);
+	unsigned checksum = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int pass = 0; pass < BENCH_PASSES; pass++)
+	{
+		HighlightState state = HighlightState::NORMAL;
+		for (const std::string& line : lines)
+		{
+			state = HighlightLine(*syntax, line.data(), line.size(), state, styles.data());
+			checksum += static_cast<unsigned>(styles[line.size() / 2]);
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	double totalTokens = static_cast<double>(tokens) * BENCH_PASSES;
+	double totalBytes = static_cast<double>(bytes) * BENCH_PASSES;
+	printf("highlight: %zu lines x %d passes, %.3f s\n", lines.size(), BENCH_PASSES, seconds);
+	printf("highlight: %.1f M tokens/s, %.1f MB/s (checksum %u)\n", totalTokens / seconds / 1e6, totalBytes / seconds / 1e6, checksum);
+
+	return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * RenderBench.cpp - the memory, load time and frame time of the render policy the editor is compiled with.
+ * Also checks that the frames do not allocate memory after the warm-up.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Editor.hpp>
+#include <TerminalHeadless.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "BenchAllocations.hpp"
+
+/// The size of the drawn screen.
+#define BENCH_COLUMNS 200
+#define BENCH_ROWS 60
+/// The least count of drawn frames per file. The file is scrolled down and up by pages until it is reached.
+#define BENCH_MIN_FRAMES 500
+
+/// Return the seconds since start.
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+	if (argc < 2)
+	{
+		fprintf(stderr, "Usage: %s pathToFile...\n", argv[0]);
+		return 1;
+	}
+
+	printf("render policy: %s\n", Buffer::RenderPolicy::NAME);
+	printf("%-40s %8s %10s %10s %12s %10s %8s\n", "file", "rows", "memory KiB", "load ms", "highlight ms", "frame us", "allocs");
+
+	size_t totalMemory = 0;
+	double totalLoad = 0, totalHighlight = 0, totalFrames = 0;
+	int frameCount = 0;
+	size_t totalAllocations = 0;
+	for (int i = 1; i < argc; i++)
+	{
+		Buffer buffer(argv[i]);
+		auto start = std::chrono::steady_clock::now();
+		try
+		{
+			buffer.Load();
+		}
+		catch (const EditorFileIOError& error)
+		{
+			fprintf(stderr, "%s: %s\n", argv[i], error.what());
+			continue;
+		}
+		double load = SecondsSince(start);
+		size_t memory = buffer.GetMemoryUsage();
+
+		// The whole file is highlighted before the frames are drawn, so every frame draws the colored rows.
+		Editor editor({ argv[i] }, SIZE_MAX);
+		// Only the editor is measured, the output is not parsed.
+		std::shared_ptr<HeadlessTerminal> terminal = std::make_shared<HeadlessTerminal>(TerminalCoord { BENCH_COLUMNS, BENCH_ROWS });
+		terminal->SetGridEnabled(false);
+		editor.RefreshScreen(*terminal);
+		start = std::chrono::steady_clock::now();
+		while (editor.HasBackgroundWork())
+		{
+			editor.ProcessBackgroundWork();
+		}
+		double highlight = SecondsSince(start);
+
+		// Every page down (or up) scrolls the view, so the frame redraws all the rows.
+		// The first pass down and up is the warm-up: the reused buffers grow to the longest row and the largest frame,
+		// after it the frames must not allocate.
+		int pages = buffer.GetRowCount() / BENCH_ROWS + 1;
+		int frames = 0;
+		size_t allocations = 0;
+		start = std::chrono::steady_clock::now();
+		for (bool down = true; frames < BENCH_MIN_FRAMES; down = !down)
+		{
+			for (int page = 0; page < pages; page++, frames++)
+			{
+				editor.ProcessKey(TerminalKey(down ? TerminalKeys::PAGE_DOWN : TerminalKeys::PAGE_UP, false, false));
+
+				size_t before = g_Allocations;
+				editor.RefreshScreen(*terminal);
+				allocations += frames >= 2 * pages ? g_Allocations - before : 0;
+				terminal->ClearFrameBytes();
+			}
+		}
+		double frameTime = SecondsSince(start);
+
+		printf("%-40s %8d %10zu %10.2f %12.2f %10.2f %8zu\n", argv[i], buffer.GetRowCount(), memory / 1024,
+			load * 1e3, highlight * 1e3, frameTime / frames * 1e6, allocations);
+
+		totalMemory += memory;
+		totalLoad += load;
+		totalHighlight += highlight;
+		totalFrames += frameTime;
+		frameCount += frames;
+		totalAllocations += allocations;
+	}
+
+	printf("%-40s %8s %10zu %10.2f %12.2f %10.2f %8zu\n", "total", "", totalMemory / 1024,
+		totalLoad * 1e3, totalHighlight * 1e3, frameCount > 0 ? totalFrames / frameCount * 1e6 : 0.0, totalAllocations);
+
+	if (totalAllocations != 0)
+	{
+		fprintf(stderr, "The frames made %zu allocations after the warm-up.\n", totalAllocations);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,331 @@
+/*
+ * TraceBench.cpp - the throughput and latency of the editor replaying key traces on a headless terminal.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Editor.hpp>
+#include <TerminalHeadless.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BenchAllocations.hpp"
+
+/// The size of the screen.
+#define BENCH_COLUMNS 120
+#define BENCH_ROWS 40
+
+// A trace is a text file, every line is a command:
+//   # comment
+//   text CHARACTERS    type the characters up to the end of the line
+//   key NAME [COUNT]   press a key: a character or ARROW_UP, ARROW_DOWN, ARROW_LEFT, ARROW_RIGHT,
+//                      PAGE_UP, PAGE_DOWN, HOME, END, DELETE, BACKSPACE, ESCAPE, TAB, ENTER
+//   ctrl CHARACTER [COUNT]   press Ctrl and the character
+//   tabstop SIZE       change the tab size, as the settings do
+//   repeat COUNT       repeat the commands up to the matching "end"
+//   end
+// Every key and every tab size change is followed by a frame, as in the loop of the editor when the keys come faster
+// than the background work.
+
+/// A step of a trace: a key or a change of the tab size.
+struct TraceStep
+{
+	TerminalKey key = TerminalKey(0, false, false);
+	/// The new tab size. 0 if the step is a key.
+	int tabStop = 0;
+};
+
+/// The names of the special keys of a trace.
+static const struct
+{
+	const char* name;
+	TerminalKey key;
+} g_KeyNames[] =
+{
+	{ "ARROW_UP", TerminalKey(TerminalKeys::ARROW_UP, false, false) },
+	{ "ARROW_DOWN", TerminalKey(TerminalKeys::ARROW_DOWN, false, false) },
+	{ "ARROW_LEFT", TerminalKey(TerminalKeys::ARROW_LEFT, false, false) },
+	{ "ARROW_RIGHT", TerminalKey(TerminalKeys::ARROW_RIGHT, false, false) },
+	{ "PAGE_UP", TerminalKey(TerminalKeys::PAGE_UP, false, false) },
+	{ "PAGE_DOWN", TerminalKey(TerminalKeys::PAGE_DOWN, false, false) },
+	{ "HOME", TerminalKey(TerminalKeys::HOME, false, false) },
+	{ "END", TerminalKey(TerminalKeys::END, false, false) },
+	{ "DELETE", TerminalKey(TerminalKeys::DELETE, false, false) },
+	{ "BACKSPACE", TerminalKey(TerminalKeys::BACKSPACE, false, false) },
+	{ "ESCAPE", TerminalKey(TerminalKeys::ESCAPE, false, false) },
+	{ "TAB", TerminalKey('\t', false, false) },
+	// The terminal reads ENTER as Ctrl-M.
+	{ "ENTER", TerminalKey('m', true, false) },
+};
+
+/// Read the steps of the trace file. Return false and print the error if the trace is wrong.
+static bool ReadTrace(const char* path, std::vector<TraceStep>& steps)
+{
+	std::ifstream file(path);
+	if (!file)
+	{
+		fprintf(stderr, "%s: unable to open the trace\n", path);
+		return false;
+	}
+
+	// The first step and the count of every open repeat.
+	std::vector<std::pair<size_t, int>> repeats;
+	std::string line;
+	for (int lineNumber = 1; std::getline(file, line); lineNumber++)
+	{
+		std::istringstream stream(line);
+		std::string command;
+		stream >> command;
+
+		TraceStep step;
+		int count = 1;
+		if (command.empty() || command[0] == '#')
+		{
+			continue;
+		}
+		else if (command == "text")
+		{
+			// The characters start after the single space that follows the command.
+			size_t start = line.find("text") + 5;
+			for (char ch : line.substr(start < line.size() ? start : line.size()))
+			{
+				step.key = TerminalKey(ch, false, false);
+				steps.push_back(step);
+			}
+			continue;
+		}
+		else if (command == "key" || command == "ctrl")
+		{
+			std::string name;
+			stream >> name;
+			if (!(stream >> count))
+			{
+				count = 1;
+			}
+
+			bool found = false;
+			for (const auto& keyName : g_KeyNames)
+			{
+				if (command == "key" && name == keyName.name)
+				{
+					step.key = keyName.key;
+					found = true;
+				}
+			}
+			if (!found && name.size() == 1)
+			{
+				step.key = TerminalKey(name[0], command == "ctrl", false);
+				found = true;
+			}
+			if (!found)
+			{
+				fprintf(stderr, "%s:%d: unknown key '%s'\n", path, lineNumber, name.c_str());
+				return false;
+			}
+		}
+		else if (command == "tabstop")
+		{
+			if (!(stream >> step.tabStop) || step.tabStop <= 0)
+			{
+				fprintf(stderr, "%s:%d: the tab size must be positive\n", path, lineNumber);
+				return false;
+			}
+		}
+		else if (command == "repeat")
+		{
+			if (!(stream >> count) || count <= 0)
+			{
+				fprintf(stderr, "%s:%d: the count must be positive\n", path, lineNumber);
+				return false;
+			}
+			repeats.push_back({ steps.size(), count });
+			continue;
+		}
+		else if (command == "end")
+		{
+			if (repeats.empty())
+			{
+				fprintf(stderr, "%s:%d: 'end' without 'repeat'\n", path, lineNumber);
+				return false;
+			}
+
+			size_t first = repeats.back().first;
+			size_t last = steps.size();
+			for (int i = 1; i < repeats.back().second; i++)
+			{
+				steps.insert(steps.end(), steps.begin() + first, steps.begin() + last);
+			}
+			repeats.pop_back();
+			continue;
+		}
+		else
+		{
+			fprintf(stderr, "%s:%d: unknown command '%s'\n", path, lineNumber, command.c_str());
+			return false;
+		}
+
+		steps.insert(steps.end(), count, step);
+	}
+
+	if (!repeats.empty())
+	{
+		fprintf(stderr, "%s: 'repeat' without 'end'\n", path);
+		return false;
+	}
+	return true;
+}
+
+/// Return the value at the fraction of the sorted values.
+static double Percentile(const std::vector<double>& sorted, double fraction)
+{
+	if (sorted.empty())
+	{
+		return 0;
+	}
+	size_t index = static_cast<size_t>(fraction * (sorted.size() - 1) + 0.5);
+	return sorted[index];
+}
+
+/// The names of the color depths of the -c option.
+static const struct
+{
+	const char* name;
+	TerminalColorDepth depth;
+} g_ColorDepthNames[] =
+{
+	{ "truecolor", TerminalColorDepth::TRUE_COLOR },
+	{ "256", TerminalColorDepth::COLORS_256 },
+	{ "16", TerminalColorDepth::COLORS_16 },
+};
+
+int main(int argc, char** argv)
+{
+	// The frames are written as for a terminal of the color depth.
+	TerminalColorDepth depth = TerminalColorDepth::TRUE_COLOR;
+	// The frames are drawn through the virtual interface of Terminal, not on HeadlessTerminal by its type.
+	bool virtualCalls = false;
+	while (argc > 1 && argv[1][0] == '-')
+	{
+		if (strcmp(argv[1], "-v") == 0)
+		{
+			virtualCalls = true;
+			argc--;
+			argv++;
+			continue;
+		}
+
+		if (argc < 3 || strcmp(argv[1], "-c") != 0)
+		{
+			break;
+		}
+
+		bool found = false;
+		for (const auto& depthName : g_ColorDepthNames)
+		{
+			if (strcmp(argv[2], depthName.name) == 0)
+			{
+				depth = depthName.depth;
+				found = true;
+			}
+		}
+		if (!found)
+		{
+			fprintf(stderr, "Unknown color depth '%s', expected truecolor, 256 or 16.\n", argv[2]);
+			return 1;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s [-c truecolor|256|16] [-v] pathToFile pathToTrace...\n", argv[0]);
+		return 1;
+	}
+
+	printf("terminal calls: %s\n", virtualCalls ? "virtual" : "static");
+	printf("%-28s %7s %10s %9s %9s %12s %12s\n", "trace", "frames", "frames/s", "p50 us", "p99 us", "bytes/frame", "allocs/frame");
+
+	bool failed = false;
+	for (int i = 2; i < argc; i++)
+	{
+		std::vector<TraceStep> steps;
+		if (!ReadTrace(argv[i], steps))
+		{
+			failed = true;
+			continue;
+		}
+
+		// Every trace starts from the same file, highlighted as if the user waited after opening it.
+		Editor editor({ argv[1] }, SIZE_MAX);
+		std::shared_ptr<HeadlessTerminal> terminal = std::make_shared<HeadlessTerminal>(TerminalCoord { BENCH_COLUMNS, BENCH_ROWS });
+		terminal->SetGridEnabled(false);
+		terminal->SetColorDepth(depth);
+		auto refreshScreen = [&editor, &terminal, virtualCalls]()
+		{
+			if (virtualCalls)
+			{
+				editor.RefreshScreen<Terminal>(*terminal);
+			}
+			else
+			{
+				editor.RefreshScreen(*terminal);
+			}
+		};
+
+		refreshScreen();
+		while (editor.HasBackgroundWork())
+		{
+			editor.ProcessBackgroundWork();
+		}
+		refreshScreen();
+		terminal->ClearFrameBytes();
+
+		// The latency of a step is from the key to the flush of its frame.
+		std::vector<double> latencies;
+		latencies.reserve(steps.size());
+		size_t bytes = 0;
+		size_t allocations = 0;
+		double total = 0;
+		for (const TraceStep& step : steps)
+		{
+			auto start = std::chrono::steady_clock::now();
+			if (step.tabStop != 0)
+			{
+				editor.SetTabSize(step.tabStop);
+			}
+			else
+			{
+				editor.ProcessKey(step.key);
+			}
+
+			size_t before = g_Allocations;
+			refreshScreen();
+			allocations += g_Allocations - before;
+
+			double latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			latencies.push_back(latency);
+			total += latency;
+
+			bytes += terminal->GetFrameBytes().back();
+			terminal->ClearFrameBytes();
+		}
+
+		std::sort(latencies.begin(), latencies.end());
+		const char* name = std::strrchr(argv[i], '/') != nullptr ? std::strrchr(argv[i], '/') + 1 : argv[i];
+		double frames = steps.empty() ? 1 : steps.size();
+		printf("%-28s %7zu %10.0f %9.2f %9.2f %12.1f %12.2f\n", name, steps.size(), total > 0 ? steps.size() / total : 0.0,
+			Percentile(latencies, 0.5) * 1e6, Percentile(latencies, 0.99) * 1e6, bytes / frames, allocations / frames);
+	}
+
+	return failed ? 1 : 0;
+}
@@ -0,0 +1,314 @@
+/*
+ * Buffer.hpp - the text of a file that is shown by the views.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_BUFFER_HPP
+#define EDITOR_BUFFER_HPP
+
+#include <vector>
+#include <string>
+#include <exception>
+#include <filesystem>
+#include <chrono>
+#include <memory>
+
+#include "Terminal.hpp"
+#include "Highlight.hpp"
+#include "HighlightWorker.hpp"
+#include "PoolAllocator.hpp"
+#include "InlineChars.hpp"
+#include "RenderPolicy.hpp"
+
+#ifndef ROW_INLINE_SIZE
+/// The size of the storage of the row characters, the rows that are shorter than it are stored without an allocation.
+#define ROW_INLINE_SIZE 16
+#endif
+
+// The render characters are kept in the rows, unless EDITOR_RENDER_ON_THE_FLY is defined.
+// Then the tabs are expanded every time a row is drawn or highlighted, see RenderPolicy.hpp.
+
+/// If some error occurse while opening, reading or writing to the file, then EditorFileIOError thrown.
+class EditorFileIOError : std::exception
+{
+public:
+	/// The constructor of EditorFileIOError.
+	EditorFileIOError(const char* msg)
+		: m_Msg(msg)
+	{}
+
+	/// Return the error message.
+	virtual const char* what() const noexcept
+	{
+		return m_Msg;
+	}
+
+private:
+	/// The message of error cause.
+	const char* m_Msg;
+};
+
+/// Receives the changes of a Buffer, so the things that depend on the rows are updated.
+class BufferListener
+{
+public:
+	/// A virtual destructor of a BufferListener.
+	virtual ~BufferListener() {}
+
+	/// Called after the text of the rows [first; first + count) was changed.
+	virtual void OnRowsChanged(int first, int count) = 0;
+	/// Called after the rows [first; first + count) look differently, but their text is the same (highlighting, tabs).
+	virtual void OnRowsRestyled(int first, int count) = 0;
+	/// Called after count rows were inserted (count > 0) or erased (count < 0) at y.
+	virtual void OnRowsShifted(int y, int count) = 0;
+};
+
+/// The rows of a file with their highlighting and the undo history.
+/// Note: a buffer does not know about cursors, the positions of the edits are passed to it.
+class Buffer
+{
+public:
+	/// The characters of a row. The short rows are kept inside the row, the longer ones are allocated from the pool of the buffer.
+	using Chars = InlineChars<ROW_INLINE_SIZE>;
+	/// How the render characters of the rows are kept.
+#ifdef EDITOR_RENDER_ON_THE_FLY
+	using RenderPolicy = OnTheFlyRender<Chars>;
+#else
+	using RenderPolicy = CachedRender<Chars>;
+#endif
+
+	/// A line of the buffer.
+	struct Row
+	{
+		/// Create an empty row which characters are allocated from the pool.
+		explicit Row(BlockPool* pool)
+			: real(pool),
+			  render(pool)
+		{}
+
+		/// The characters of the line as they are in the file.
+		Chars real;
+		/// The render characters of the line, if the policy keeps them. Use Buffer::GetRender to read them.
+		RenderPolicy::RowCache render;
+		/// The styled runs of the render characters.
+		HighlightSpans highlight;
+		/// The state of the highlighter at the end of the row, the next row is highlighted from it.
+		HighlightState highlightState = HighlightState::UNKNOWN;
+		/// The checkpoints of the render columns, if the row has at least RENDER_COLUMNS_MIN_SIZE characters. Otherwise nullptr.
+		/// Note: the copies of the row share it, so it is changed in place only while the row is its only owner.
+		std::shared_ptr<RenderColumns> columns;
+	};
+
+	/// Create a buffer of the file. The file is not read until Load.
+	Buffer(const std::filesystem::path& filePath);
+
+	Buffer(const Buffer&) = delete;
+	Buffer& operator=(const Buffer&) = delete;
+
+	/// Return the absolute path to the file.
+	const std::string& GetFilePath() const
+	{ return m_FilePath; }
+
+	/// Return the name of the file.
+	const std::string& GetFileName() const
+	{ return m_FileName; }
+
+	/// Return true if the file did not exist when the buffer was loaded.
+	bool IsNewFile() const
+	{ return m_NewFile; }
+
+	/// Return true if the buffer was changed after the last save.
+	bool IsDirty() const
+	{ return m_Dirty; }
+
+	/// Return true if the rows are in memory.
+	bool IsLoaded() const
+	{ return m_Loaded; }
+
+	/// Read the rows from the file, if they are not loaded. May throw an EditorFileIOError.
+	/// Note: if the file does not exist, then the buffer is empty and the file is created on save.
+	void Load();
+	/// Free the rows and the highlighting, Load reads them from the file again.
+	/// The undo history is kept, unless the file is changed by then: Load drops it, because its positions are in the old rows.
+	/// Return false if the buffer has unsaved changes, so it can not be unloaded.
+	bool Unload();
+	/// Return the approximate count of bytes used by the rows and the undo history.
+	/// Note: every row is visited, so it should not be called on every key press.
+	size_t GetMemoryUsage() const;
+
+	/// Save the buffer to the file. May throw an EditorFileIOError.
+	void Save();
+
+	/// Return the count of rows.
+	int GetRowCount() const
+	{ return m_Rows.size(); }
+
+	/// Return the row at y.
+	const Row& GetRow(int y) const
+	{ return m_Rows[y]; }
+
+	/// Return the count of columns between the tab stops.
+	int GetTabStop() const
+	{ return m_TabStop; }
+
+	/// Change the count of columns between the tab stops. Throw std::out_of_range if the size is not positive.
+	void SetTabStop(int newSize);
+
+	/// Return the characters of the row as they are drawn (the tabs are expanded).
+	/// Note: the characters may be expanded into scratch, they are valid until scratch or the row is changed.
+	RenderChars GetRender(const Row& row, std::vector<char>& scratch) const
+	{ return RenderPolicy::Get(row.real, row.render, m_TabStop, scratch); }
+
+	/// Return the part [from; to) of the render characters of the row, it is cut at the end of the row.
+	/// Only the part is expanded, so a window of a long row costs O(log n + width) and not O(n).
+	/// Note: the characters may be expanded into scratch, they are valid until scratch or the row is changed.
+	RenderChars GetRenderRange(const Row& row, int from, int to, std::vector<char>& scratch) const
+	{ return RenderPolicy::GetRange(row.real, row.render, row.columns.get(), m_TabStop, from, to, scratch); }
+
+	/// Return the render X coordinate of the character at cx in the row, continuing from the known pair (fromCx; fromRx).
+	/// Note: a long row continues from its nearest checkpoint, if it is closer.
+	int RowCxToRx(const Row& row, int cx, int fromCx = 0, int fromRx = 0) const;
+	/// Return the X coordinate of the character that covers the render X coordinate rx in the row.
+	/// The size of the row if rx is after its end.
+	int RowRxToCx(const Row& row, int rx) const;
+
+	/// Return the syntax of the file. nullptr if the file is not highlighted.
+	const HighlightSyntax* GetSyntax() const
+	{ return m_Syntax; }
+
+	/// Add the listener of the changes.
+	/// Note: the listener must be removed before it is destroyed.
+	void AddListener(BufferListener* listener);
+	/// Remove the listener of the changes.
+	void RemoveListener(BufferListener* listener);
+
+	/// Insert the character at the position. If at.y is the count of rows, then a new row is appended.
+	void InsertChar(TerminalCoord at, char ch);
+	/// Delete the character before the position. At the start of a row, join the row to the previous one.
+	void DeleteChar(TerminalCoord at);
+	/// Split the row at the position.
+	void InsertNewLine(TerminalCoord at);
+	/// Undo the last change and set the cursor to its position before the change. Return false if there is nothing to undo.
+	bool Undo(TerminalCoord& cursor);
+	/// End the run of merged edits, so the next edit starts a new undo record. Called when a cursor is moved.
+	void EndUndoMerge()
+	{ m_UndoMergeable = false; }
+	/// Replace all occurrences of query with replacement as one undoable change, the cursor is remembered for the undo.
+	/// Return the count of replaced occurrences, changedLines is set to the count of changed lines.
+	/// Note: every changed line is rebuilt once. The lines are split into chunks that are processed in parallel.
+	size_t ReplaceAll(const std::string& query, const std::string& replacement, TerminalCoord cursor, int& changedLines);
+
+	/// Return true if the highlighting is not finished, or the count rows starting at first are not highlighted.
+	bool HasHighlightWork(int first, int count) const;
+	/// Apply the result of m_HighlightWorker and give it the next job, the count rows starting at first are highlighted before others.
+	/// Stop when there is no more time.
+	void ProcessHighlightWork(std::chrono::steady_clock::time_point deadline, int first, int count);
+
+private:
+	/// The absolute path to the file.
+	std::string m_FilePath;
+	/// The name of the file.
+	std::string m_FileName;
+	/// Did the file not exist when the buffer was loaded.
+	bool m_NewFile = false;
+	/// Was the buffer modified after the last save.
+	bool m_Dirty = false;
+	/// Are the rows read from the file.
+	bool m_Loaded = false;
+
+	/// The pool of the characters of m_Rows. The rows are freed by slabs, not one by one.
+	/// Note: it is used only by the main thread.
+	BlockPool m_RowPool;
+	/// The rows of the file.
+	std::vector<Row> m_Rows;
+	/// The count of columns between the tab stops.
+	int m_TabStop = 4;
+
+	/// The objects that are notified about the changes.
+	std::vector<BufferListener*> m_Listeners;
+
+	/// Notify the listeners about the changed text of the rows.
+	void NotifyRowsChanged(int first, int count);
+	/// Notify the listeners about the changed look of the rows.
+	void NotifyRowsRestyled(int first, int count);
+	/// Update the highlighting after count rows were inserted (count > 0) or erased (count < 0) at y, then notify the listeners.
+	void ShiftRows(int y, int count);
+
+	void AppendRow(const std::string& str);
+	/// Rebuild the render characters of the row after its real characters were changed from the real X coordinate from onward.
+	void UpdateRow(Row& row, int from = 0);
+	/// Insert a character to a buffer row.
+	void RowInsertChar(Row& row, int at, char ch);
+	/// Delete a character in a buffer row.
+	void RowDeleteChar(Row& row, int at);
+
+	/// A part of an undoable change: the lines [first; first + newCount) replaced oldLines.
+	struct UndoHunk
+	{
+		int first;
+		int newCount;
+		std::vector<std::vector<char>> oldLines;
+	};
+
+	/// An undoable change. All its hunks are undone at once.
+	struct UndoRecord
+	{
+		std::vector<UndoHunk> hunks;
+		/// The cursor before the change.
+		TerminalCoord cursor;
+	};
+
+	/// The changes that can be undone, the last one is on the top.
+	std::vector<UndoRecord> m_UndoStack;
+
+	/// The size of the file when the buffer was unloaded, Load compares the file with it.
+	std::uintmax_t m_UnloadedFileSize = 0;
+	/// The time of the last write of the file when the buffer was unloaded, Load compares the file with it.
+	std::filesystem::file_time_type m_UnloadedFileTime;
+	/// Return the size and the time of the last write of the file. If the file cannot be queried, they are static_cast<std::uintmax_t>(-1) and file_time_type::min().
+	void GetFileStatus(std::uintmax_t& size, std::filesystem::file_time_type& time) const;
+	/// Drop the undo history, if the file was changed after the buffer was unloaded.
+	void CheckUndoHistory();
+
+	/// Can the next mergeable edit be merged into the record on the top of m_UndoStack.
+	/// Only the consecutive character inserts and deletes inside one line set it, every other change and a cursor move clear it.
+	bool m_UndoMergeable = false;
+
+	/// Remember the oldCount lines starting at first before they are replaced by newCount lines, and the cursor before the change.
+	/// Note: a mergeable edit inside the line of the last mergeable edit is merged into its record.
+	void RecordUndo(TerminalCoord cursor, int first, int oldCount, int newCount, bool mergeable = false);
+
+	/// The syntax of the file. nullptr if the file is not highlighted.
+	const HighlightSyntax* m_Syntax = nullptr;
+
+	/// Highlight count rows starting at y, then continue with the next rows while their end state differs from the cached one.
+	/// Note: a row that changed its end position (joined or split) should get the cached state of the row it takes the end from, or HighlightState::UNKNOWN.
+	/// Note: at most HIGHLIGHT_SYNC_ROWS rows are highlighted at once, the rest and the rows of at least RENDER_COLUMNS_MIN_SIZE characters are left to m_HighlightWorker.
+	void HighlightRows(int y, int count);
+
+	/// Highlights the rows in the background.
+	std::unique_ptr<HighlightWorker> m_HighlightWorker;
+	/// Incremented on every change of rows, so the results of m_HighlightWorker for the old rows are dropped.
+	unsigned m_HighlightVersion = 0;
+	/// The sorted rows from which the highlighting must be continued in the background.
+	std::vector<int> m_HighlightPending;
+	/// The styles of a row, reused by HighlightRows for every row.
+	std::vector<HighlightStyle> m_HighlightStyles;
+	/// The render characters of a row, reused by the highlighting for every row.
+	std::vector<char> m_HighlightRender;
+	/// The spans of a row, reused by HighlightRows for every row.
+	std::vector<HighlightSpan> m_HighlightSpans;
+
+	/// Apply the spans and the end states of the result to its rows. The rows that still need highlighting are added to m_HighlightPending.
+	/// Return the count of applied rows.
+	int ApplyHighlight(const HighlightWorker::Result& result);
+	/// Add the row to m_HighlightPending.
+	void AddHighlightPending(int y);
+	/// Remove the rows [first; last] from m_HighlightPending.
+	void RemoveHighlightPending(int first, int last);
+};
+
+#endif // EDITOR_BUFFER_HPP
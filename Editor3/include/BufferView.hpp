@@ -0,0 +1,192 @@
+/*
+ * BufferView.hpp - a view of a buffer with its own cursor, scroll position and damage.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_BUFFER_VIEW_HPP
+#define EDITOR_BUFFER_VIEW_HPP
+
+#include <memory>
+#include <vector>
+
+#include "Terminal.hpp"
+#include "Buffer.hpp"
+#include "WrapIndex.hpp"
+
+/// How a view shares its area with its child view.
+enum class SplitType
+{
+	NONE,       /// The view has no child.
+	HORIZONTAL, /// The child is below the view, they are separated by a row.
+	VERTICAL,   /// The child is to the right of the view, they are separated by a column.
+};
+
+/// A rectangle of the terminal that shows a buffer. Several views may show one buffer, every view has its own cursor and scroll position.
+/// The views form a chain: a split view gives a part of its area to its child.
+/// Note: a view remembers which of its screen rows must be redrawn (damaged). The changes of the buffer damage only the rows they affect.
+class BufferView : public BufferListener
+{
+public:
+	/// Create a view of the buffer with the cursor at the start.
+	BufferView(std::shared_ptr<Buffer> buffer);
+	/// Stop listening to the buffer. The child views are destroyed too.
+	~BufferView();
+
+	BufferView(const BufferView&) = delete;
+	BufferView& operator=(const BufferView&) = delete;
+
+	/// Return the shown buffer.
+	const std::shared_ptr<Buffer>& GetBuffer() const
+	{ return m_Buffer; }
+
+	/// Return the cursor in the buffer.
+	TerminalCoord GetCursor() const
+	{ return m_Cursor; }
+	/// Move the cursor in the buffer.
+	void SetCursor(TerminalCoord cursor);
+
+	/// Return the position in the buffer that is the top left corner of the view.
+	TerminalCoord GetOffset() const
+	{ return m_Offset; }
+	/// Scroll the view, so the position is the top left corner.
+	void SetOffset(TerminalCoord offset);
+	/// Move the cursor into the buffer and scroll the view back to its rows, after the buffer was read again and may be shorter.
+	void ClampToBuffer();
+
+	/// Return the render X coordinate of the cursor. Valid after Scroll.
+	int GetRx() const
+	{ return m_Rx; }
+	/// Return the cursor in the screen coordinates of the view. Valid after Scroll.
+	TerminalCoord GetCursorOnScreen() const;
+	/// Return the buffer row shown at the screen row y of the view (y) and the render X coordinate the screen row starts from (x).
+	/// The row may be after the last row of the buffer. Valid after Scroll.
+	TerminalCoord GetRowStart(int y) const;
+
+	/// Return true if the rows wider than the view continue on the next screen rows.
+	bool IsWrapped() const
+	{ return m_Wrapped; }
+	/// Turn the wrapping of the wide rows on or off.
+	void SetWrapped(bool wrapped);
+
+	/// Return the top left corner of the view in the terminal.
+	TerminalCoord GetPosition() const
+	{ return m_Position; }
+	/// Return the size of the view (without the separator from the child).
+	TerminalCoord GetSize() const
+	{ return m_Size; }
+
+	/// Move the cursor according to an arrow, PAGE_UP, PAGE_DOWN, HOME or END key.
+	void MoveCursor(TerminalKey key);
+	/// Insert the character at the cursor.
+	void InsertChar(char ch);
+	/// Delete the character before the cursor.
+	void DeleteChar();
+	/// Split the row at the cursor.
+	void InsertNewLine();
+	/// Undo the last change of the buffer. Return false if there was nothing to undo.
+	bool Undo();
+
+	/// Keep the cursor inside the buffer and change the offset if the cursor is out of the view.
+	void Scroll();
+
+	/// Split the view: a new view of the same buffer becomes the child and gets a part of the area.
+	/// Return the new view.
+	/// Note: the views must be laid out again.
+	BufferView* Split(SplitType type);
+	/// Return the child view. nullptr if the view is not split.
+	BufferView* GetChild() const
+	{ return m_Child.get(); }
+	/// Return how the view shares its area with the child.
+	SplitType GetSplitType() const
+	{ return m_Split; }
+	/// Destroy the child view, its own child takes its place.
+	void CloseChild();
+	/// Give away the child view with its children. The view is not split anymore.
+	std::unique_ptr<BufferView> ReleaseChild();
+
+	/// Place the view and its children into the rectangle of the terminal.
+	void Layout(TerminalCoord position, TerminalCoord size);
+
+	/// Mark the whole view to be redrawn.
+	void Invalidate();
+	/// Return true if the screen row y of the view must be redrawn.
+	bool IsRowDamaged(int y) const
+	{ return m_DamagedRows[y]; }
+	/// Return true if any screen row or the separator of the view must be redrawn.
+	bool IsDamaged() const;
+	/// Return true if the separator from the child must be redrawn. False if the separator does not fit the area of the view.
+	bool IsSeparatorDamaged() const
+	{ return m_SeparatorDamaged && m_SeparatorShown; }
+	/// Forget the damage after the view was drawn.
+	void ClearDamage();
+
+	virtual void OnRowsChanged(int first, int count) override;
+	virtual void OnRowsRestyled(int first, int count) override;
+	virtual void OnRowsShifted(int y, int count) override;
+
+private:
+	/// The shown buffer.
+	std::shared_ptr<Buffer> m_Buffer;
+
+	/// The state of the cursor in buffer.
+	TerminalCoord m_Cursor = { 0, 0 };
+	/// The real X coordinate of the screen. When there is no tabs it is equal to m_Cursor.x, else it will be greater depending on tab count and tab stop.
+	int m_Rx = 0;
+	/// Position in the file that is the top left corner of the view.
+	TerminalCoord m_Offset = { 0, 0 };
+
+	/// Are the wide rows wrapped. Then m_Offset.x is 0 and the view starts from the line m_OffsetLine of the row m_Offset.y.
+	bool m_Wrapped = false;
+	/// The first shown line of the row m_Offset.y when the rows are wrapped.
+	int m_OffsetLine = 0;
+	/// The lines of the wrapped rows. Only kept while the rows are wrapped.
+	WrapIndex m_Wrap;
+	/// The tab stop the rows of m_Wrap were measured with.
+	int m_WrapTabStop = 0;
+
+	/// The top left corner of the view in the terminal.
+	TerminalCoord m_Position = { 0, 0 };
+	/// The size of the view.
+	TerminalCoord m_Size = { 0, 0 };
+
+	/// Is the change of the buffer made by this view. Its cursor is moved by the edit itself, not by the notifications.
+	bool m_Editing = false;
+
+	/// The screen rows of the view that must be redrawn.
+	std::vector<bool> m_DamagedRows;
+	/// Must the separator from the child be redrawn.
+	bool m_SeparatorDamaged = false;
+	/// Does the separator from the child fit the area of the view. It does not when the area is empty.
+	bool m_SeparatorShown = false;
+
+	/// How the view shares its area with m_Child.
+	SplitType m_Split = SplitType::NONE;
+	/// The view that shows the rest of the area.
+	std::unique_ptr<BufferView> m_Child;
+	/// The part of the area that is kept by the view.
+	float m_SplitFactor = 0.5f;
+
+	/// Mark the screen rows that show the buffer rows [first; first + count) to be redrawn.
+	void InvalidateRows(int first, int count);
+	/// Move the cursor into the buffer, if the buffer was changed by another view.
+	void ClampCursor();
+
+	/// Make m_Wrap match the rows, the tab stop and the width of the view. The rows are measured again only if the buffer was reloaded or the tab stop was changed.
+	void UpdateWrap();
+	/// Return the render width of the row y.
+	int GetRowWidth(int y) const;
+	/// Return the first shown line of the wrapped rows.
+	int GetTopLine() const
+	{ return m_Wrap.GetFirstLine(m_Offset.y) + m_OffsetLine; }
+	/// Scroll the wrapped rows, so the line is the first shown line.
+	void SetTopLine(int line);
+	/// Scroll the wrapped rows, so the cursor is shown.
+	void ScrollWrapped();
+	/// Move the cursor by a page of the wrapped rows.
+	void MovePageWrapped(bool up);
+};
+
+#endif // EDITOR_BUFFER_VIEW_HPP
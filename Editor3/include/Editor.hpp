@@ -2,41 +2,43 @@
 #define EDITOR_EDITOR_HPP
 
 #include <vector>
-#include <exception>
 #include <filesystem>
+#include <memory>
 
 #include "Terminal.hpp"
+#include "Search.hpp"
+#include "Regex.hpp"
+#include "RegexSearch.hpp"
+#include "Buffer.hpp"
+#include "BufferView.hpp"
 
-/// If some error occurse while opening, reading or writing to the file, then EditorFileIOError thrown.
-class EditorFileIOError : std::exception
+/// What the editor should do with the text entered in the message bar prompt.
+enum class PromptAction
 {
-public:
-	/// The constructor of EditorFileIOError.
-	EditorFileIOError(const char* msg)
-		: m_Msg(msg)
-	{}
-
-	/// Return the error message.
-	virtual const char* what() const noexcept
-	{
-		return m_Msg;
-	}
-
-private:
-	/// The message of error cause.
-	const char* m_Msg;
+	NONE,         /// There is no active prompt.
+	MACRO_REPLAY, /// Replay the recorded macro the entered count of times.
+	SEARCH,       /// Incrementally search the entered text.
+	REGEX_SEARCH, /// Incrementally search the entered regular expression in the background.
+	REPLACE_FIND, /// Ask the text to replace, then ask the replacement.
+	REPLACE_WITH, /// Replace all occurrences of m_ReplaceQuery with the entered text.
 };
 
 /// The editor.
-class Editor
+class Editor : public BufferListener
 {
 public:
-	/// Create an editor with file.
-	/// Note: if the file does not exist, then a new file is created.
-	Editor(const std::filesystem::path& filePath);
+	/// Create an editor with the files, the first one is shown. The other files are read when they are shown the first time.
+	/// The clean buffers that were not shown for the longest time are unloaded while the loaded buffers use more than memoryBudget bytes.
+	/// Note: if a file does not exist, then a new file is created.
+	Editor(const std::vector<std::filesystem::path>& filePaths, size_t memoryBudget);
+	/// Stop listening to the buffer.
+	~Editor();
 	
 	/// Redraw the editor screen.
-	void RefreshScreen(std::shared_ptr<Terminal> terminal);
+	/// TerminalType is Terminal to draw through the virtual interface, or a final backend, then the calls are resolved at compile time.
+	/// Note: the drawing is instantiated in Editor.cpp for Terminal, HeadlessTerminal and UnixTerminal.
+	template <typename TerminalType>
+	void RefreshScreen(TerminalType& terminal);
 	/// Process the key. Return true if the editor is alive, otherwise, false.
 	/// Note: may throw an EditorFileIOError.
 	bool ProcessKey(TerminalKey key);
@@ -46,90 +48,214 @@ public:
 	
 	/// Change the tab size.
 	void SetTabSize(int newSize);
+
+	/// Return true if the editor has work that is done in the background (like a search), so ProcessBackgroundWork should be called periodically.
+	bool HasBackgroundWork() const;
+	/// Apply the results of the background work. Should be followed by RefreshScreen.
+	void ProcessBackgroundWork();
+
+	virtual void OnRowsChanged(int first, int count) override;
+	virtual void OnRowsRestyled(int first, int count) override;
+	virtual void OnRowsShifted(int y, int count) override;
 	
 private:
-	/// The state of the cursor in buffer.
-	TerminalCoord m_Cursor = { 0, 0 };
-	/// The real X coordinate of the screen. When there is no tabs it is equal to m_Cursor.x, else it will be greater depending on tab count and tab stop.
-	int m_Rx = m_Cursor.x;
 	/// The last known size of the terminal.
 	TerminalCoord m_TerminalSize = { 0, 0 };
-	/// The size of buffer area (origin at the (0;0) of the terminal).
-	TerminalCoord m_BufferArea = { 0, 0 };
 
-	/// Position in the file that is the top left corner of the editor terminal.
-	TerminalCoord m_Offset = { 0, 0 };
+	/// An opened file with its views.
+	struct OpenBuffer
+	{
+		std::shared_ptr<Buffer> buffer;
+		/// The first view of the chain of views.
+		std::unique_ptr<BufferView> rootView;
+		/// The view that received the keys when the buffer was active.
+		BufferView* activeView = nullptr;
+		/// The value of m_SwitchCount when the buffer stopped being active. The buffer with the least value is unloaded first.
+		unsigned lastUsed = 0;
+	};
+
+	/// The opened files.
+	std::vector<OpenBuffer> m_Buffers;
+	/// The index of the shown buffer in m_Buffers.
+	size_t m_ActiveBuffer = 0;
+	/// The count of the buffer switches.
+	unsigned m_SwitchCount = 0;
+	/// The count of bytes the loaded buffers may use before the inactive ones are unloaded.
+	size_t m_MemoryBudget;
+	
+	/// The shown buffer.
+	std::shared_ptr<Buffer> m_Buffer;
+	/// The view that receives the keys.
+	BufferView* m_ActiveView = nullptr;
+
+	/// Return the first view of the shown buffer.
+	BufferView* GetRootView() const
+	{ return m_Buffers[m_ActiveBuffer].rootView.get(); }
 
-	/// The count of spaces that is used for representing tabs.
-	// TODO: It is not the count of spaces.
-	int m_TabStop = 4;
+	/// Show the buffer at index in m_Buffers. Its file is read if the buffer is not loaded.
+	/// Note: may throw an EditorFileIOError, then the shown buffer is not changed.
+	void SwitchBuffer(size_t index);
+	/// Unload the clean inactive buffers, the least recently used first, until the loaded buffers fit m_MemoryBudget.
+	void EvictBuffers();
+
+	/// Place the views into the terminal area above the status bar.
+	void LayoutViews();
+	/// Mark all the views to be redrawn, for example, when the search matches change.
+	void InvalidateViews();
+	/// Split the active view, the new view becomes active.
+	void SplitView(SplitType type);
+	/// Close the active view, unless it is the last one.
+	void CloseView();
+	/// Make the next view in the chain active.
+	void NextView();
+	/// Turn the wrapping of the long rows on or off in all the views.
+	void ToggleWrap();
 
 	/// The color of characters' background.
 	TerminalColor m_BackgroundColor = { 0, 0, 0 };
 	/// The color of characters.
 	TerminalColor m_ForegroundColor = { 255, 255, 255 };
+	/// The color of search matches' background.
+	TerminalColor m_MatchBackgroundColor = { 255, 200, 0 };
+	/// The color of search matches' characters.
+	TerminalColor m_MatchForegroundColor = { 0, 0, 0 };
 	
-	/// Convert buffer cursor X coordinate to real terminal X coordinate.
-	void ConvertCxToRx();
-	
-	// TODO: DOCUMENT.
-	struct Row
-	{
-		std::vector<char> real;
-		std::vector<char> render;
-	};
+	/// Save the buffer to its file.
+	void Save();
 
-	/// Insert a character to a buffer row.
-	void RowInsertChar(Row& row, int at, char ch);
-	/// Delete a character in a buffer row.
-	void RowDeleteChar(Row& row, int at);
-	
-	/// Insert the character to the current row.
-	void InsertChar(char ch);
-	/// Delete the character in the current row.
-	void DeleteChar();
-	/// Create new line.
-	void InsertNewLine();
+	/// The text that is replaced by the replace prompt.
+	std::string m_ReplaceQuery;
 	
-	/// The absolute path to the current opened file.
-	std::string m_FilePath;
-	/// The name of the current opened file.
-	std::string m_FileName;
-
-	// TODO: Document.
-	std::vector<Row> m_Buffer;
-
-	/// Was file modified.
-	bool m_FileDirty = false;
-
-	/// Save the buffer to the m_FilePath.
-	void Save();
+	/// Replace all occurrences of query with replacement as one undoable change.
+	void ReplaceAll(const std::string& query, const std::string& replacement);
 	
 	/// The contents of editor's message bar.
 	std::string m_MessageBarText;
 	/// The count of screen refereshes before clearing m_StatusLine.
 	int m_MessageBarTextLifeTime;
 	
-	void AppendRow(const std::string& str);
-	void UpdateRow(Row& row);
+	/// Apply the streamed matches of m_RegexSearch.
+	void ProcessRegexWork();
+	/// The shown render characters of the drawn row, if the render policy expands them on the fly. A member, so the memory is reused.
+	std::vector<char> m_RenderScratch;
+	/// Print the render characters [from; to) of the row with their highlight colors. render is the part of the row from renderStart.
+	template <typename TerminalType>
+	void DrawRenderRange(const Buffer::Row& row, RenderChars render, int renderStart, int from, int to, TerminalType& terminal);
 	
-	/// Draw editor main rows.
-	void DrawRows(std::shared_ptr<Terminal> terminal);
-	/// Draw tilda or welcome message.
-	void DrawDefaultRow(int y, std::shared_ptr<Terminal> terminal);
-	/// Draw the status bar.
-	void DrawStatusBar(std::shared_ptr<Terminal> terminal);
-	/// Draw the message bar.
-	void DrawMessageBar(std::shared_ptr<Terminal> terminal);
-
-	/// Change the m_RowOffset if the m_Cursor is out of range of m_TerminalScreen.
-	void Scroll();
-	
-	/// Move cursor according to the key.
-	void ProcessMoveCursor(TerminalKey key);
+	/// Draw the damaged rows of the view and its separator from the child.
+	template <typename TerminalType>
+	void DrawView(BufferView& view, TerminalType& terminal);
+	/// Draw the screen row y of the view. Return the count of written characters.
+	template <typename TerminalType>
+	int DrawViewRow(BufferView& view, int y, TerminalType& terminal);
+	/// Draw tilda or welcome message. Return the count of written characters.
+	template <typename TerminalType>
+	int DrawDefaultRow(BufferView& view, int y, TerminalType& terminal);
+	/// Print the character count times.
+	template <typename TerminalType>
+	void WriteRepeated(char ch, int count, TerminalType& terminal);
+	/// The characters printed by WriteRepeated. A member, so the memory is reused.
+	std::string m_RepeatedChars;
+	/// Build the status bar of the current frame in m_StatusBarText.
+	void BuildStatusBar();
+	/// The status bar of the current frame, it fills the width of the terminal. A member, so the memory is reused.
+	std::string m_StatusBarText;
+	/// The status bar that is shown in the terminal.
+	std::string m_DrawnStatusBar;
+	/// Build the message bar of the current frame in m_MessageBarLine.
+	void BuildMessageBar();
+	/// The message bar of the current frame, it fills the width of the terminal. A member, so the memory is reused.
+	std::string m_MessageBarLine;
+	/// The message bar that is shown in the terminal.
+	std::string m_DrawnMessageBar;
+	/// Print the characters of the line that differ from drawn (the line shown at the terminal row y), then remember the line as drawn.
+	/// Note: if the lines have different sizes, then the whole line is printed.
+	template <typename TerminalType>
+	void DrawChangedCells(const std::string& line, std::string& drawn, int y, TerminalType& terminal);
 
     // TODO: DOCUMENT
 	int m_ExitConfirmations = 3;
+
+	/// The label of the prompt shown in the message bar before the entered text.
+	std::string m_PromptLabel;
+	/// The text entered in the prompt.
+	std::string m_PromptInput;
+	/// The action of the active prompt. PromptAction::NONE when there is no prompt.
+	PromptAction m_PromptAction = PromptAction::NONE;
+
+	/// Show a prompt in the message bar. The next keys are redirected to the prompt until ENTER or ESCAPE.
+	void StartPrompt(const std::string& label, PromptAction action);
+	/// Process the key while the prompt is active.
+	void ProcessPromptKey(TerminalKey key);
+	/// Perform the action of the prompt with the entered text.
+	void FinishPrompt();
+	/// Cancel the prompt.
+	void CancelPrompt();
+	/// Called after every change of the entered text.
+	void OnPromptInputChanged();
+
+	/// The text which matches are highlighted. Empty if there is no search or the search is a regex search.
+	std::string m_SearchQuery;
+	/// The regular expression which matches are highlighted. nullptr if there is no regex search.
+	std::shared_ptr<const Regex> m_SearchRegex;
+	/// The matcher of m_SearchRegex that is used by the editor thread.
+	std::unique_ptr<RegexMatcher> m_RegexMatcher;
+	/// The matches of the current row found by FindRowMatches. A member, so the memory is reused.
+	std::vector<LineMatch> m_RowMatches;
+	
+	/// The background regex search. Created on the first regex search.
+	std::unique_ptr<RegexSearch> m_RegexSearch;
+	/// The copy of the buffer that m_RegexSearch searches in. It belongs to the prompt of the regex search, so it is dropped when the prompt ends.
+	std::shared_ptr<const BufferSnapshot> m_RegexSnapshot;
+	/// Is m_RegexSearch running.
+	bool m_RegexSearching = false;
+	/// The matches taken from m_RegexSearch. A member, so the memory is reused.
+	std::vector<BufferMatch> m_StreamedMatches;
+	/// Has the cursor been moved to a match by the user, so the streamed matches should not move it anymore.
+	bool m_RegexCursorFixed = false;
+
+	/// The matches of the current search in the whole buffer.
+	MatchIndex m_MatchIndex;
+	/// Is m_MatchIndex used. If it is not, the matches are searched in the drawn rows.
+	bool m_MatchIndexActive = false;
+
+	/// Find the matches of the current search (m_SearchQuery or m_SearchRegex) in the row, store them in m_RowMatches.
+	void FindRowMatches(const Buffer::Row& row);
+	/// Return the sorted matches of the current search in the row at y. Return nullptr if there are none.
+	const std::vector<LineMatch>* GetRowMatches(int y);
+	/// Fill m_MatchIndex with the matches of m_SearchQuery in the whole buffer.
+	void BuildMatchIndex();
+	/// Search the changed row at y again and update m_MatchIndex.
+	void UpdateRowMatches(int y);
+	/// Stop the search and forget its matches.
+	void ClearSearch();
+	/// Start the background search of m_SearchRegex.
+	void StartRegexSearch();
+	/// Stop the background search. The matches that were already found are kept.
+	void StopRegexSearch();
+	/// Move the cursor to the next (or the previous) match in m_MatchIndex. Return true if there was a match.
+	bool JumpToMatch(bool forward);
+	/// The cursor position before the search was started.
+	TerminalCoord m_SearchOrigin = { 0, 0 };
+	/// The offset before the search was started.
+	TerminalCoord m_SearchOriginOffset = { 0, 0 };
+
+	/// Move the cursor to the closest match of m_SearchQuery at or after (forward), or before (backward) the position. The search wraps around the buffer.
+	/// Return true if there was a match.
+	bool SearchFrom(TerminalCoord from, bool forward);
+
+	/// Is the editor recording the keys into m_Macro.
+	bool m_MacroRecording = false;
+	/// Is the editor replaying m_Macro. The keys are not recorded during the replay.
+	bool m_MacroReplaying = false;
+	/// The recorded keys of the keyboard macro.
+	std::vector<TerminalKey> m_Macro;
+
+	/// Start or stop recording of the keyboard macro.
+	void ToggleMacroRecording();
+	/// Replay the keyboard macro. If times is 0, then replay until the cursor reaches the end of the buffer.
+	/// Note: the screen is not refreshed during the replay, only the result is drawn.
+	void ReplayMacro(int times);
 };
 
 #endif // EDITOR_EDITOR_HPP
@@ -0,0 +1,79 @@
+/*
+ * Highlight.hpp - syntax highlighting of the editor rows.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_HIGHLIGHT_HPP
+#define EDITOR_HIGHLIGHT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Terminal.hpp"
+#include "PoolAllocator.hpp"
+
+/// The style of a highlighted character.
+enum class HighlightStyle : unsigned char
+{
+	NORMAL,
+	KEYWORD,
+	TYPE,
+	STRING,
+	NUMBER,
+	COMMENT,
+	PREPROCESSOR,
+};
+
+/// The state of the lexer at the end of a line, so the next line continues from it.
+enum class HighlightState : unsigned char
+{
+	NORMAL,        /// Nothing continues on the next line.
+	BLOCK_COMMENT, /// The line ended inside a block comment.
+	UNKNOWN,       /// The line was not highlighted yet (or changed). Never equal to a real state.
+};
+
+/// A run of characters with the same style.
+struct HighlightSpan
+{
+	/// The render index of the first character.
+	uint32_t start;
+	/// The count of characters. Longer runs are split into several spans.
+	uint16_t length;
+	HighlightStyle style;
+};
+
+/// The sorted spans of a row. The characters outside of the spans have the NORMAL style.
+using HighlightSpans = std::vector<HighlightSpan, PoolAllocator<HighlightSpan>>;
+
+/// Highlight the line which starts in the state. Write a style per character to styles and return the state at the end of the line.
+using HighlightFunction = HighlightState (*)(const char* line, size_t size, HighlightState state, HighlightStyle* styles);
+
+/// The description of a language for the highlighter.
+struct HighlightSyntax
+{
+	/// The name of the language shown in the status bar.
+	const char* name;
+	/// The file extensions (with the dot) of the language.
+	std::vector<std::string> extensions;
+	/// The lexer of the language with its keywords compiled in.
+	HighlightFunction highlight;
+};
+
+/// Return the syntax for the file by its extension. Return nullptr if the language is not supported.
+const HighlightSyntax* FindHighlightSyntax(const std::string& fileName);
+
+/// Highlight the line which starts in the state. Write a style per character to styles and return the state at the end of the line.
+HighlightState HighlightLine(const HighlightSyntax& syntax, const char* line, size_t size, HighlightState state, HighlightStyle* styles);
+
+/// Append the runs of the not NORMAL styles to the spans.
+void AppendHighlightSpans(const HighlightStyle* styles, size_t size, std::vector<HighlightSpan>& spans);
+
+/// Return the color of characters in the style.
+TerminalColor GetHighlightColor(HighlightStyle style);
+
+#endif // EDITOR_HIGHLIGHT_HPP
@@ -0,0 +1,90 @@
+/*
+ * HighlightWorker.hpp - syntax highlighting on a background thread.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_HIGHLIGHT_WORKER_HPP
+#define EDITOR_HIGHLIGHT_WORKER_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Highlight.hpp"
+
+/// Highlights copies of rows on a background thread, one job at a time.
+/// Note: the methods of HighlightWorker must be called from one thread.
+class HighlightWorker
+{
+public:
+	/// Rows to highlight.
+	struct Job
+	{
+		/// The version of the buffer the rows were copied from. The result is stale if the buffer has another version.
+		unsigned version;
+		/// The index of the first copied row.
+		int firstRow;
+		/// The state at the end of the row before firstRow.
+		HighlightState startState;
+		/// The copies of the rendered rows.
+		std::vector<std::vector<char>> lines;
+	};
+
+	/// The highlighted rows of a job.
+	struct Result
+	{
+		unsigned version;
+		int firstRow;
+		/// The spans of all the rows of the job, one row after another.
+		std::vector<HighlightSpan> spans;
+		/// The count of spans of every row.
+		std::vector<uint32_t> spanCounts;
+		/// The end state of every row of the job.
+		std::vector<HighlightState> endStates;
+	};
+	
+	/// Start the thread that highlights with the syntax.
+	HighlightWorker(const HighlightSyntax& syntax);
+	/// Stop the thread. The current job is finished first.
+	~HighlightWorker();
+
+	/// Return true if the worker has a job which result is not taken.
+	bool IsBusy() const;
+	/// Give the job to the worker.
+	/// Note: the worker must not be busy.
+	void Start(Job job);
+	/// Wait for the result of the job up to the timeout (in miliseconds). Return false if it is not ready.
+	bool TakeResult(Result& result, int timeout);
+
+private:
+	/// The syntax of the highlighted rows.
+	const HighlightSyntax& m_Syntax;
+	
+	std::thread m_Thread;
+	/// Guards the fields below.
+	std::mutex m_Mutex;
+	/// Signalled when there is a new job or the worker stops.
+	std::condition_variable m_JobReady;
+	/// Signalled when the result is ready.
+	std::condition_variable m_ResultReady;
+
+	bool m_HasJob = false;
+	bool m_HasResult = false;
+	bool m_Stopping = false;
+	/// Is there a job which result is not taken yet. Only used by the owner thread.
+	bool m_Busy = false;
+	
+	Job m_Job;
+	Result m_Result;
+	/// The styles of the current line, reused for every line. Only used by the worker thread.
+	std::vector<HighlightStyle> m_Styles;
+
+	/// The main function of the thread.
+	void WorkerLoop();
+};
+
+#endif // EDITOR_HIGHLIGHT_WORKER_HPP
@@ -0,0 +1,287 @@
+/*
+ * InlineChars.hpp - an array of characters that keeps short contents inside itself.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_INLINE_CHARS_HPP
+#define EDITOR_INLINE_CHARS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+
+#include "PoolAllocator.hpp"
+
+/// A growing array of characters like std::vector<char>. Up to SIZE - 1 characters are stored inside the object,
+/// longer contents are moved to a block of the pool (or of operator new, if there is no pool).
+/// Note: the object takes SIZE bytes and the pointer to the pool. The pool must outlive the array.
+template <size_t SIZE>
+class InlineChars
+{
+	static_assert(SIZE >= 16 && SIZE <= 128, "the storage must fit the heap fields and the inline size must fit the tag");
+	
+public:
+	using value_type = char;
+	using iterator = char*;
+	using const_iterator = const char*;
+
+	/// The count of characters that are stored without an allocation.
+	static constexpr size_t INLINE_CAPACITY = SIZE - 1;
+
+	/// Create an empty array which long contents are allocated from the pool.
+	explicit InlineChars(BlockPool* pool = nullptr)
+		: m_Pool(pool)
+	{
+		this->SetInlineSize(0);
+	}
+
+	InlineChars(const InlineChars& other)
+		: InlineChars(other.m_Pool)
+	{
+		this->assign(other.begin(), other.end());
+	}
+
+	InlineChars(InlineChars&& other) noexcept
+		: m_Pool(other.m_Pool)
+	{
+		std::memcpy(m_Storage, other.m_Storage, SIZE);
+		other.SetInlineSize(0);
+	}
+
+	~InlineChars()
+	{
+		this->Free();
+	}
+
+	InlineChars& operator=(const InlineChars& other)
+	{
+		if (this != &other)
+		{
+			this->assign(other.begin(), other.end());
+		}
+		return *this;
+	}
+
+	InlineChars& operator=(InlineChars&& other) noexcept
+	{
+		if (this == &other)
+		{
+			return *this;
+		}
+
+		// The heap block can be taken only from an array of the same pool.
+		if (other.IsInline() || other.m_Pool != m_Pool)
+		{
+			this->assign(other.begin(), other.end());
+			return *this;
+		}
+
+		this->Free();
+		std::memcpy(m_Storage, other.m_Storage, SIZE);
+		other.SetInlineSize(0);
+		return *this;
+	}
+
+	size_t size() const
+	{ return this->IsInline() ? m_Storage[SIZE - 1] & ~INLINE_TAG : this->GetHeap().size; }
+	size_t capacity() const
+	{ return this->IsInline() ? INLINE_CAPACITY : size_t(1) << this->GetHeap().capacityBits; }
+	bool empty() const
+	{ return this->size() == 0; }
+
+	char* data()
+	{ return this->IsInline() ? m_Storage : this->GetHeap().data; }
+	const char* data() const
+	{ return this->IsInline() ? m_Storage : this->GetHeap().data; }
+
+	char* begin()
+	{ return this->data(); }
+	char* end()
+	{ return this->data() + this->size(); }
+	const char* begin() const
+	{ return this->data(); }
+	const char* end() const
+	{ return this->data() + this->size(); }
+
+	char& operator[](size_t index)
+	{ return this->data()[index]; }
+	char operator[](size_t index) const
+	{ return this->data()[index]; }
+
+	/// Make the capacity at least the count of characters.
+	void reserve(size_t capacity)
+	{
+		if (capacity <= this->capacity())
+		{
+			return;
+		}
+
+		// The capacity is a power of two, so the blocks fit the size classes of the pool.
+		uint8_t capacityBits = 0;
+		while ((size_t(1) << capacityBits) < capacity)
+		{
+			capacityBits++;
+		}
+
+		size_t size = this->size();
+		char* block = this->Allocate(size_t(1) << capacityBits);
+		std::memcpy(block, this->data(), size);
+		this->Free();
+		
+		Heap heap = { block, static_cast<uint32_t>(size), capacityBits };
+		this->SetHeap(heap);
+	}
+
+	void clear()
+	{ this->SetSize(0); }
+
+	/// Change the count of characters, the new characters are zeros.
+	void resize(size_t size)
+	{
+		size_t oldSize = this->size();
+		this->reserve(size);
+		if (size > oldSize)
+		{
+			std::memset(this->data() + oldSize, 0, size - oldSize);
+		}
+		this->SetSize(size);
+	}
+
+	void push_back(char ch)
+	{
+		size_t size = this->size();
+		this->reserve(size + 1);
+		this->data()[size] = ch;
+		this->SetSize(size + 1);
+	}
+
+	template <typename Iterator>
+	void assign(Iterator first, Iterator last)
+	{
+		this->SetSize(0);
+		this->insert(this->end(), first, last);
+	}
+
+	char* insert(const char* position, char ch)
+	{
+		return this->insert(position, &ch, &ch + 1);
+	}
+
+	/// Insert the characters [first; last) before the position. The characters must not be a part of the array.
+	template <typename Iterator>
+	char* insert(const char* position, Iterator first, Iterator last)
+	{
+		size_t at = position - this->data();
+		size_t count = std::distance(first, last);
+		size_t size = this->size();
+		this->reserve(size + count);
+
+		char* chars = this->data();
+		std::memmove(chars + at + count, chars + at, size - at);
+		for (size_t i = 0; i < count; i++, first++)
+		{
+			chars[at + i] = *first;
+		}
+		this->SetSize(size + count);
+		return chars + at;
+	}
+
+	char* erase(const char* position)
+	{
+		return this->erase(position, position + 1);
+	}
+
+	char* erase(const char* first, const char* last)
+	{
+		char* chars = this->data();
+		size_t size = this->size();
+		size_t at = first - chars;
+		size_t count = last - first;
+		std::memmove(chars + at, chars + at + count, size - at - count);
+		this->SetSize(size - count);
+		return chars + at;
+	}
+
+private:
+	/// The fields of the characters that are moved to a block.
+	struct Heap
+	{
+		char* data;
+		uint32_t size;
+		/// log2 of the capacity of the block.
+		uint8_t capacityBits;
+	};
+	/// The count of bytes of the storage that hold the fields of a Heap, the padding is not copied.
+	static constexpr size_t HEAP_BYTES = offsetof(Heap, capacityBits) + sizeof(Heap::capacityBits);
+	static_assert(HEAP_BYTES < 16, "the last byte of the storage is the tag");
+
+	/// Set in the last byte of the storage while the characters are inline, the rest of the byte is their count.
+	static constexpr char INLINE_TAG = char(0x80);
+
+	/// The pool of the long contents. nullptr if they are allocated with operator new.
+	BlockPool* m_Pool;
+	/// Either the inline characters with the tagged count in the last byte, or a Heap.
+	char m_Storage[SIZE];
+
+	bool IsInline() const
+	{ return (m_Storage[SIZE - 1] & INLINE_TAG) != 0; }
+
+	Heap GetHeap() const
+	{
+		Heap heap;
+		std::memcpy(&heap, m_Storage, HEAP_BYTES);
+		return heap;
+	}
+
+	void SetHeap(const Heap& heap)
+	{
+		std::memcpy(m_Storage, &heap, HEAP_BYTES);
+		m_Storage[SIZE - 1] = 0;
+	}
+
+	void SetInlineSize(size_t size)
+	{ m_Storage[SIZE - 1] = INLINE_TAG | static_cast<char>(size); }
+
+	void SetSize(size_t size)
+	{
+		if (this->IsInline())
+		{
+			this->SetInlineSize(size);
+			return;
+		}
+
+		Heap heap = this->GetHeap();
+		heap.size = size;
+		this->SetHeap(heap);
+	}
+
+	char* Allocate(size_t size)
+	{
+		return static_cast<char*>(m_Pool != nullptr ? m_Pool->Allocate(size) : ::operator new(size));
+	}
+
+	/// Free the block, if the characters are not inline.
+	void Free()
+	{
+		if (this->IsInline())
+		{
+			return;
+		}
+
+		Heap heap = this->GetHeap();
+		if (m_Pool != nullptr)
+		{
+			m_Pool->Deallocate(heap.data, size_t(1) << heap.capacityBits);
+		}
+		else
+		{
+			::operator delete(heap.data);
+		}
+	}
+};
+
+#endif // EDITOR_INLINE_CHARS_HPP
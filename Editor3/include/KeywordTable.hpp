@@ -0,0 +1,157 @@
+/*
+ * KeywordTable.hpp - perfect hash tables of words built at compile time.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_KEYWORD_TABLE_HPP
+#define EDITOR_KEYWORD_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/// A word and the value it maps to.
+template <typename Value>
+struct KeywordEntry
+{
+	/// The word.
+	std::string_view word;
+	/// The value of the word.
+	Value value;
+};
+
+/// A perfect hash table of N words, built in a constexpr constructor.
+/// Every word gets its own slot, so a lookup is one hash and at most one compare.
+template <typename Value, size_t N>
+class KeywordTable
+{
+public:
+	/// Build the table: search for a multiplier which gives every word its own slot.
+	/// Note: the words must be different. The table fails to compile if they are not or if no multiplier was found.
+	constexpr KeywordTable(const KeywordEntry<Value> (&entries)[N])
+	{
+		for (size_t i = 0; i < N; i++)
+		{
+			for (size_t j = 0; j < i; j++)
+			{
+				if (entries[j].word == entries[i].word)
+				{
+					throw "KeywordTable: the words must be different";
+				}
+			}
+
+			m_Entries[i] = entries[i];
+			m_Hashes[i] = Hash(entries[i].word.data(), entries[i].word.size());
+			if (entries[i].word.size() > m_MaxLength)
+			{
+				m_MaxLength = entries[i].word.size();
+			}
+		}
+
+		for (uint32_t seed = 0; seed < MAX_SEEDS; seed++)
+		{
+			m_Multiplier = seed * 2 + 0x9E3779B1u;
+			if (this->TryFillSlots())
+			{
+				return;
+			}
+		}
+
+		// Not a constant expression, so a failed search is a compile error.
+		throw "KeywordTable: no perfect hash was found";
+	}
+
+	/// Return the value of the word or missing if the word is not in the table.
+	constexpr Value Find(const char* word, size_t size, Value missing) const
+	{
+		if (size > m_MaxLength)
+		{
+			return missing;
+		}
+
+		Slot slot = m_Slots[this->GetSlotIndex(Hash(word, size))];
+		if (slot == EMPTY_SLOT)
+		{
+			return missing;
+		}
+
+		const KeywordEntry<Value>& entry = m_Entries[slot];
+		return entry.word == std::string_view(word, size) ? entry.value : missing;
+	}
+
+private:
+	/// The index of an entry in a slot.
+	using Slot = std::conditional_t<(N < 0xFF), uint8_t, uint16_t>;
+
+	/// The slot without an entry.
+	static constexpr Slot EMPTY_SLOT = static_cast<Slot>(-1);
+	/// log2 of the count of slots. With 8 slots per word a free multiplier is found in a few tries.
+	static constexpr unsigned SLOT_BITS = [] { unsigned bits = 3; while ((size_t(1) << bits) < N * 8) bits++; return bits; }();
+	/// The count of slots.
+	static constexpr size_t SLOT_COUNT = size_t(1) << SLOT_BITS;
+	/// The count of multipliers tried before giving up.
+	static constexpr uint32_t MAX_SEEDS = 1024;
+
+	/// FNV-1a hash of the word.
+	static constexpr uint32_t Hash(const char* word, size_t size)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<unsigned char>(word[i]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	/// Return the slot of the hash. The high bits of the product depend on all the bits of the hash.
+	constexpr size_t GetSlotIndex(uint32_t hash) const
+	{
+		return static_cast<uint32_t>(hash * m_Multiplier) >> (32 - SLOT_BITS);
+	}
+
+	/// Put every entry into its slot with m_Multiplier. Return false if two entries got the same slot.
+	constexpr bool TryFillSlots()
+	{
+		for (size_t i = 0; i < SLOT_COUNT; i++)
+		{
+			m_Slots[i] = EMPTY_SLOT;
+		}
+
+		for (size_t i = 0; i < N; i++)
+		{
+			size_t index = this->GetSlotIndex(m_Hashes[i]);
+			if (m_Slots[index] != EMPTY_SLOT)
+			{
+				return false;
+			}
+			m_Slots[index] = static_cast<Slot>(i);
+		}
+
+		return true;
+	}
+
+	/// The words and their values.
+	KeywordEntry<Value> m_Entries[N] = {};
+	/// The hashes of m_Entries, so the search of the multiplier does not hash the words again.
+	uint32_t m_Hashes[N] = {};
+	/// The index of the entry in every slot, or EMPTY_SLOT.
+	Slot m_Slots[SLOT_COUNT] = {};
+	/// The multiplier which maps the hashes to different slots.
+	uint32_t m_Multiplier = 0;
+	/// The length of the longest word. Longer words are not hashed.
+	size_t m_MaxLength = 0;
+};
+
+/// Build the KeywordTable of the entries, so the count of the words is not written by hand.
+template <typename Value, size_t N>
+constexpr KeywordTable<Value, N> MakeKeywordTable(const KeywordEntry<Value> (&entries)[N])
+{
+	return KeywordTable<Value, N>(entries);
+}
+
+#endif // EDITOR_KEYWORD_TABLE_HPP
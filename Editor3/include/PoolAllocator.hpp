@@ -0,0 +1,98 @@
+/*
+ * PoolAllocator.hpp - size class pool of small blocks.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_POOL_ALLOCATOR_HPP
+#define EDITOR_POOL_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/// Allocates small blocks from big slabs. A block size is rounded up to a power of two,
+/// and the freed blocks of every size are kept in a list and given out again.
+/// Note: the pool is not thread safe.
+class BlockPool
+{
+public:
+	BlockPool() = default;
+	BlockPool(const BlockPool&) = delete;
+	BlockPool& operator=(const BlockPool&) = delete;
+
+	/// Allocate a block of at least size bytes.
+	void* Allocate(size_t size);
+	/// Return the block of the size to the pool.
+	/// Note: the size must be the same as in Allocate.
+	void Deallocate(void* block, size_t size);
+	/// Free all the slabs at once, the big blocks are not touched.
+	/// Note: the blocks that were allocated from the slabs must not be used anymore.
+	void Clear();
+
+	/// Return the count of bytes taken from the system: the slabs and the blocks that are too big for them.
+	size_t GetAllocatedSize() const
+	{ return m_Slabs.size() * SLAB_SIZE + m_BigBlocksSize; }
+
+private:
+	/// log2 of the smallest block size.
+	static constexpr size_t MIN_BLOCK_BITS = 3;
+	/// log2 of the biggest pooled block size. Bigger blocks are allocated with operator new.
+	static constexpr size_t MAX_BLOCK_BITS = 12;
+	/// The size of a slab the blocks are cut from.
+	static constexpr size_t SLAB_SIZE = 64 * 1024;
+
+	/// A free block holds the pointer to the next one.
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	/// Return the index of the size class of the size.
+	static size_t GetSizeClass(size_t size);
+
+	/// The lists of the free blocks of every size class.
+	FreeBlock* m_FreeLists[MAX_BLOCK_BITS - MIN_BLOCK_BITS + 1] = {};
+	/// All the slabs, they are freed with the pool.
+	std::vector<std::unique_ptr<char[]>> m_Slabs;
+	/// The not used part of the last slab.
+	char* m_SlabCursor = nullptr;
+	char* m_SlabEnd = nullptr;
+	/// The total size of the blocks that are allocated with operator new.
+	size_t m_BigBlocksSize = 0;
+};
+
+/// Return the pool of the highlighting data.
+/// Note: it must be used only by the main thread.
+BlockPool& GetHighlightPool();
+
+/// A standard allocator over GetHighlightPool(), so the containers of the rows do not call malloc for every small array.
+template <typename T>
+class PoolAllocator
+{
+public:
+	using value_type = T;
+
+	PoolAllocator() = default;
+	template <typename U>
+	PoolAllocator(const PoolAllocator<U>&) {}
+
+	T* allocate(size_t count)
+	{
+		return static_cast<T*>(GetHighlightPool().Allocate(count * sizeof(T)));
+	}
+
+	void deallocate(T* pointer, size_t count)
+	{
+		GetHighlightPool().Deallocate(pointer, count * sizeof(T));
+	}
+
+	template <typename U>
+	bool operator==(const PoolAllocator<U>&) const { return true; }
+	template <typename U>
+	bool operator!=(const PoolAllocator<U>&) const { return false; }
+};
+
+#endif // EDITOR_POOL_ALLOCATOR_HPP
@@ -0,0 +1,170 @@
+/*
+ * Regex.hpp - regular expressions matched with a lazily built DFA.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_REGEX_HPP
+#define EDITOR_REGEX_HPP
+
+#include <bitset>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Search.hpp"
+
+/// If the pattern of a regular expression is wrong, then RegexSyntaxError thrown.
+class RegexSyntaxError : std::exception
+{
+public:
+	/// The constructor of RegexSyntaxError.
+	RegexSyntaxError(const char* msg)
+		: m_Msg(msg)
+	{}
+
+	/// Return the error message.
+	virtual const char* what() const noexcept
+	{
+		return m_Msg;
+	}
+
+private:
+	/// The message of error cause.
+	const char* m_Msg;
+};
+
+/// A compiled regular expression.
+/// Supported syntax: characters, '.', classes '[a-z]' and '[^a-z]', '\d', '\w', '\s' (and '\D', '\W', '\S'), escaped characters,
+/// groups '(...)', alternation '|', repetitions '*', '+', '?' and anchors '^', '$'.
+/// Note: a Regex is immutable after the construction, so it may be shared by RegexMatcher instances of different threads.
+class Regex
+{
+public:
+	/// Compile the pattern. May throw a RegexSyntaxError.
+	Regex(const std::string& pattern);
+
+private:
+	friend class RegexMatcher;
+
+	/// A state of the NFA (Thompson construction).
+	struct NfaState
+	{
+		enum Type
+		{
+			CHARS, /// Consume one character from the chars set and go to out.
+			SPLIT, /// Go to out and out1 without consuming.
+			EMPTY, /// Go to out without consuming.
+			BOL,   /// Go to out only at the beginning of the line.
+			EOL,   /// Go to out only at the end of the line.
+			MATCH, /// The pattern matched.
+		};
+
+		Type type;
+		std::bitset<256> chars;
+		int out = -1;
+		int out1 = -1;
+	};
+
+	/// A part of the NFA under construction: the start state and the dangling outs ((state << 1) | isOut1) to be patched.
+	struct Fragment
+	{
+		int start;
+		std::vector<int> outs;
+	};
+
+	/// The states of the NFA.
+	std::vector<NfaState> m_States;
+	/// The start state of the NFA.
+	int m_Start = -1;
+
+	/// The pattern being compiled.
+	const std::string* m_Pattern = nullptr;
+	/// The position of the parser in m_Pattern.
+	size_t m_Pos = 0;
+
+	/// Add a state and return its index.
+	int AddState(NfaState::Type type);
+	/// Point all dangling outs of the fragment to the state.
+	void Patch(const Fragment& fragment, int state);
+	
+	/// Parse 'a|b'.
+	Fragment ParseAlternation();
+	/// Parse 'ab'.
+	Fragment ParseConcatenation();
+	/// Parse 'a*', 'a+', 'a?'.
+	Fragment ParseRepetition();
+	/// Parse a character, a class, a group or an anchor.
+	Fragment ParseAtom();
+	/// Parse the '[...]' class. The position is after '['.
+	std::bitset<256> ParseClass();
+	/// Parse the escape sequence. The position is after '\'. Return the set of characters it represents.
+	std::bitset<256> ParseEscape();
+};
+
+/// Runs a Regex over lines with a lazily built DFA.
+/// Note: the DFA cache is mutable, so a RegexMatcher is not thread-safe. Use one per thread.
+class RegexMatcher
+{
+public:
+	/// The constructor of RegexMatcher.
+	RegexMatcher(std::shared_ptr<const Regex> regex);
+
+	/// Find all non-empty, non-overlapping leftmost-longest matches in the line and append them to matches.
+	void FindAll(const char* line, size_t size, std::vector<LineMatch>& matches);
+
+private:
+	/// The count of DFA states after which the cache is dropped, so the memory is bounded on pathological patterns.
+	static constexpr size_t MAX_DFA_STATES = 4096;
+	/// The index of the dead DFA state (no NFA states).
+	static constexpr int DEAD_STATE = 0;
+	/// The transition is not computed yet.
+	static constexpr int UNKNOWN_STATE = -1;
+	
+	/// A state of the DFA: a set of NFA states.
+	struct DfaState
+	{
+		std::vector<int> nfaStates;
+		/// The pattern matched before the current position.
+		bool accepting;
+		/// The pattern matched if the current position is the end of the line.
+		bool acceptingAtEnd;
+		int next[256];
+	};
+
+	/// A lazily built DFA. The unanchored one also starts a new match at every position.
+	struct Dfa
+	{
+		bool unanchored;
+		std::vector<DfaState> states;
+		std::map<std::vector<int>, int> indices;
+		/// The start state at the beginning of the line.
+		int startAtBol;
+		/// The start state in the middle of the line.
+		int startInside;
+	};
+
+	std::shared_ptr<const Regex> m_Regex;
+	Dfa m_Anchored;
+	Dfa m_Unanchored;
+
+	/// Drop all states of the DFA and add the start states.
+	void ResetDfa(Dfa& dfa);
+	/// Add NFA state and its epsilon closure to the set.
+	void AddClosure(std::vector<int>& set, int state, bool atBol, bool atEol) const;
+	/// Return the DFA state for the NFA set, create it if needed.
+	int GetDfaState(Dfa& dfa, std::vector<int>& set);
+	/// Return the next state of the DFA after the character.
+	int Step(Dfa& dfa, int state, unsigned char ch);
+
+	/// Return the position of the earliest end of a match that starts at or after start. Return -1 if there is none.
+	long FindEarliestEnd(const char* line, size_t size, size_t start);
+	/// Return the end of the longest match that starts exactly at start. Return -1 if there is none.
+	long FindLongestEnd(const char* line, size_t size, size_t start);
+};
+
+#endif // EDITOR_REGEX_HPP
@@ -0,0 +1,101 @@
+/*
+ * RegexSearch.hpp - parallel regular expression search over a snapshot of the buffer.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_REGEX_SEARCH_HPP
+#define EDITOR_REGEX_SEARCH_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Regex.hpp"
+
+/// An immutable copy of the buffer lines, so the background searches do not race with the edits.
+struct BufferSnapshot
+{
+	/// All lines one after another without line endings.
+	std::string text;
+	/// The offsets of lines in text. There is one more offset than lines, it is the size of text.
+	std::vector<size_t> lineStarts;
+
+	/// Return the count of lines in the snapshot.
+	int GetLineCount() const
+	{ return lineStarts.size() - 1; }
+};
+
+/// Searches a Regex over a BufferSnapshot on a pool of worker threads.
+/// The lines are split into chunks which the workers take one by one, starting from the chunk of the first line and wrapping around.
+/// The matches are streamed back by TakeMatches in the order of completed chunks.
+/// Note: the methods of RegexSearch must be called from one thread.
+class RegexSearch
+{
+public:
+	/// Create the pool with workerCount threads. If workerCount is 0, then a thread per hardware thread is created.
+	RegexSearch(int workerCount = 0);
+	/// Cancel the current search and stop the workers.
+	~RegexSearch();
+
+	/// Start searching. The previous search is cancelled and its matches that were not taken are dropped.
+	void Start(std::shared_ptr<const Regex> regex, std::shared_ptr<const BufferSnapshot> snapshot, int firstLine);
+	/// Cancel the current search. The workers stop on the next checked line.
+	void Cancel();
+
+	/// Append the matches found since the last call to matches.
+	/// Return true if more matches may come, false if the search is done (or cancelled) and all its matches were taken.
+	bool TakeMatches(std::vector<BufferMatch>& matches);
+
+private:
+	/// The count of lines that a worker takes at once.
+	static constexpr int CHUNK_LINES = 4096;
+	/// The count of lines after which a worker checks if the search was cancelled.
+	static constexpr int CANCEL_CHECK_LINES = 256;
+
+	/// One search.
+	struct Job
+	{
+		std::shared_ptr<const Regex> regex;
+		std::shared_ptr<const BufferSnapshot> snapshot;
+		int firstChunk;
+		int chunkCount;
+
+		/// The index of the next chunk to take (before the wrap around firstChunk).
+		std::atomic<int> nextChunk{ 0 };
+		/// The count of chunks that are not searched yet.
+		std::atomic<int> chunksLeft{ 0 };
+		std::atomic<bool> cancelled{ false };
+
+		/// Guards found.
+		std::mutex mutex;
+		/// The matches that were not taken yet.
+		std::vector<BufferMatch> found;
+	};
+
+	std::vector<std::thread> m_Workers;
+
+	/// Guards m_Job, m_JobNumber and m_Stopping.
+	std::mutex m_Mutex;
+	/// Signalled when there is a new job or the pool stops.
+	std::condition_variable m_JobChanged;
+	/// The current search.
+	std::shared_ptr<Job> m_Job;
+	/// Incremented for every new job, so the workers know that they have not seen it yet.
+	unsigned m_JobNumber = 0;
+	/// Set when the workers should exit.
+	bool m_Stopping = false;
+
+	/// The main function of a worker thread.
+	void WorkerLoop();
+	/// Search one chunk of the job.
+	void SearchChunk(Job& job, RegexMatcher& matcher, int chunk);
+};
+
+#endif // EDITOR_REGEX_SEARCH_HPP
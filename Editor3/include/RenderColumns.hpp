@@ -0,0 +1,49 @@
+/*
+ * RenderColumns.hpp - the render X coordinates of the checkpoints of a long row.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_RENDER_COLUMNS_HPP
+#define EDITOR_RENDER_COLUMNS_HPP
+
+#include <cstddef>
+#include <vector>
+
+/// The rows of at least this count of characters are indexed by RenderColumns.
+#define RENDER_COLUMNS_MIN_SIZE 4096
+/// The count of real characters between the checkpoints.
+#define RENDER_COLUMNS_STEP 1024
+
+/// The render X coordinates of every RENDER_COLUMNS_STEP-th real character of a row.
+/// A position of a long row is converted between the real and the render coordinates from the nearest checkpoint,
+/// so it costs O(log n + RENDER_COLUMNS_STEP) and not O(n).
+class RenderColumns
+{
+public:
+	/// Index the real characters with the tab stop. O(n).
+	RenderColumns(const char* real, size_t size, int tabStop);
+
+	/// Reindex the real characters after they were changed from the real X coordinate from onward.
+	/// The checkpoints before from are kept, so an edit at the end of the row is O(RENDER_COLUMNS_STEP) if it has no tabs after it.
+	void Update(const char* real, size_t size, int tabStop, size_t from);
+
+	/// Return true if the row has tabs. Otherwise the real and the render coordinates are the same.
+	bool HasTabs() const
+	{ return m_FirstTab >= 0; }
+
+	/// Return the last checkpoint (cx; rx) with cx not after the real X coordinate. O(1).
+	void FindByCx(int cx, int& checkpointCx, int& checkpointRx) const;
+	/// Return the last checkpoint (cx; rx) with rx not after the render X coordinate. O(log n).
+	void FindByRx(int rx, int& checkpointCx, int& checkpointRx) const;
+
+private:
+	/// The real X coordinate of the first tab of the row, or -1 if it has no tabs.
+	long m_FirstTab = -1;
+	/// The render X coordinate of the real character i * RENDER_COLUMNS_STEP. Empty if the row has no tabs.
+	std::vector<int> m_Rx;
+};
+
+#endif // EDITOR_RENDER_COLUMNS_HPP
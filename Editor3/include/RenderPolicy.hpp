@@ -0,0 +1,228 @@
+/*
+ * RenderPolicy.hpp - how the render characters of the rows are kept.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_RENDER_POLICY_HPP
+#define EDITOR_RENDER_POLICY_HPP
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "PoolAllocator.hpp"
+#include "RenderColumns.hpp"
+
+/// The render characters of a row: the characters as they are drawn, the tabs are expanded to spaces up to the next tab stop.
+struct RenderChars
+{
+	const char* data;
+	size_t size;
+};
+
+/// Return the count of render characters of the real characters.
+inline size_t CountRenderSize(const char* real, size_t size, int tabStop)
+{
+	size_t renderSize = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		renderSize += real[i] == '\t' ? tabStop - (renderSize % tabStop) : 1;
+	}
+	return renderSize;
+}
+
+/// Write the render characters of the real characters to render, it must fit CountRenderSize characters.
+inline void ExpandTabs(const char* real, size_t size, int tabStop, char* render)
+{
+	size_t rx = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		if (real[i] == '\t')
+		{
+			size_t tabEnd = rx + tabStop - (rx % tabStop);
+			while (rx < tabEnd)
+			{
+				render[rx++] = ' ';
+			}
+		}
+		else
+		{
+			render[rx++] = real[i];
+		}
+	}
+}
+
+/// Return the render characters of the real characters. If they have tabs, then they are expanded into scratch.
+/// Note: the characters are valid until scratch or the real characters are changed.
+inline RenderChars ExpandRow(const char* real, size_t size, int tabStop, std::vector<char>& scratch)
+{
+	if (std::memchr(real, '\t', size) == nullptr)
+	{
+		return { real, size };
+	}
+
+	scratch.resize(CountRenderSize(real, size, tabStop));
+	ExpandTabs(real, size, tabStop, scratch.data());
+	return { scratch.data(), scratch.size() };
+}
+
+/// Return the part [from; to) of the render characters, it is cut at the end of the row. Only the characters up to to are expanded into scratch.
+/// The expansion starts from the nearest checkpoint of columns, if the row is indexed (may be nullptr).
+/// Note: the characters are valid until scratch or the row is changed.
+inline RenderChars ExpandRange(const char* real, size_t size, const RenderColumns* columns, int tabStop, int from, int to, std::vector<char>& scratch)
+{
+	if (columns != nullptr ? !columns->HasTabs() : std::memchr(real, '\t', size) == nullptr)
+	{
+		int end = to < static_cast<int>(size) ? to : size;
+		if (from >= end)
+		{
+			return { real, 0 };
+		}
+		return { real + from, static_cast<size_t>(end - from) };
+	}
+
+	int cx = 0;
+	int rx = 0;
+	if (columns != nullptr)
+	{
+		columns->FindByRx(from, cx, rx);
+	}
+
+	// The character that covers from. A tab may start before it, then only its part after from is written.
+	for (; cx < static_cast<int>(size); cx++)
+	{
+		int nextRx = real[cx] == '\t' ? rx + tabStop - (rx % tabStop) : rx + 1;
+		if (nextRx > from)
+		{
+			break;
+		}
+		rx = nextRx;
+	}
+
+	scratch.clear();
+	for (; cx < static_cast<int>(size) && rx < to; cx++)
+	{
+		if (real[cx] == '\t')
+		{
+			int tabEnd = rx + tabStop - (rx % tabStop);
+			for (; rx < tabEnd; rx++)
+			{
+				if (rx >= from)
+				{
+					scratch.push_back(' ');
+				}
+			}
+		}
+		else
+		{
+			scratch.push_back(real[cx]);
+			rx++;
+		}
+	}
+
+	// The last tab may end after to.
+	size_t rangeSize = scratch.size() < static_cast<size_t>(to - from) ? scratch.size() : to - from;
+	return { scratch.data(), rangeSize };
+}
+
+/// Every row keeps its render characters, they are rebuilt on every change of the row.
+/// Drawing and highlighting only read them, but the rows take about twice the memory and the load is slower.
+/// Note: the rows of at least RENDER_COLUMNS_MIN_SIZE characters are expanded on the fly, so an edit of a huge row does not copy it.
+template <typename Chars>
+struct CachedRender
+{
+	/// The name of the policy for the messages.
+	static constexpr const char* NAME = "cached";
+
+	/// The part of a row that belongs to the policy.
+	struct RowCache
+	{
+		explicit RowCache(BlockPool* pool)
+			: render(pool)
+		{}
+
+		/// The characters of the line as they are drawn.
+		Chars render;
+	};
+
+	/// Rebuild the cache after the real characters or the tab stop were changed.
+	static void Update(const Chars& real, RowCache& cache, int tabStop)
+	{
+		if (real.size() >= RENDER_COLUMNS_MIN_SIZE)
+		{
+			// The moved out characters are freed.
+			Chars released(std::move(cache.render));
+			return;
+		}
+
+		// The size is counted first, so the characters are written without reallocations.
+		cache.render.resize(CountRenderSize(real.data(), real.size(), tabStop));
+		ExpandTabs(real.data(), real.size(), tabStop, cache.render.data());
+	}
+
+	/// Return the render characters of the row.
+	static RenderChars Get(const Chars& real, const RowCache& cache, int tabStop, std::vector<char>& scratch)
+	{
+		if (real.size() >= RENDER_COLUMNS_MIN_SIZE)
+		{
+			return ExpandRow(real.data(), real.size(), tabStop, scratch);
+		}
+		return { cache.render.data(), cache.render.size() };
+	}
+
+	/// Return the part [from; to) of the render characters of the row, it is cut at the end of the row.
+	static RenderChars GetRange(const Chars& real, const RowCache& cache, const RenderColumns* columns, int tabStop, int from, int to, std::vector<char>& scratch)
+	{
+		if (real.size() >= RENDER_COLUMNS_MIN_SIZE)
+		{
+			return ExpandRange(real.data(), real.size(), columns, tabStop, from, to, scratch);
+		}
+
+		int end = to < static_cast<int>(cache.render.size()) ? to : cache.render.size();
+		if (from >= end)
+		{
+			return { cache.render.data(), 0 };
+		}
+		return { cache.render.data() + from, static_cast<size_t>(end - from) };
+	}
+};
+
+/// The rows keep only their real characters, the tabs are expanded every time the row is drawn or highlighted.
+/// The rows without tabs are drawn from the real characters directly.
+template <typename Chars>
+struct OnTheFlyRender
+{
+	/// The name of the policy for the messages.
+	static constexpr const char* NAME = "on-the-fly";
+
+	/// The part of a row that belongs to the policy. It is empty.
+	struct RowCache
+	{
+		explicit RowCache(BlockPool* pool)
+		{}
+	};
+
+	/// Rebuild the cache after the real characters or the tab stop were changed.
+	static void Update(const Chars& real, RowCache& cache, int tabStop)
+	{}
+
+	/// Return the render characters of the row. If the row has tabs, they are expanded into scratch.
+	/// Note: the characters are valid until scratch or the row is changed.
+	static RenderChars Get(const Chars& real, const RowCache& cache, int tabStop, std::vector<char>& scratch)
+	{
+		return ExpandRow(real.data(), real.size(), tabStop, scratch);
+	}
+
+	/// Return the part [from; to) of the render characters of the row, it is cut at the end of the row.
+	/// Only the characters of the part are expanded into scratch, so a window of a long row costs O(log n + width).
+	/// Note: the characters are valid until scratch or the row is changed.
+	static RenderChars GetRange(const Chars& real, const RowCache& cache, const RenderColumns* columns, int tabStop, int from, int to, std::vector<char>& scratch)
+	{
+		return ExpandRange(real.data(), real.size(), columns, tabStop, from, to, scratch);
+	}
+};
+
+#endif // EDITOR_RENDER_POLICY_HPP
@@ -0,0 +1,87 @@
+/*
+ * Search.hpp - substring search over the editor rows.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_SEARCH_HPP
+#define EDITOR_SEARCH_HPP
+
+#include <cstddef>
+#include <vector>
+
+/// A match of a search in a line.
+struct LineMatch
+{
+	/// The index of the first matched character.
+	int start;
+	/// The count of matched characters.
+	int length;
+};
+
+/// A match of a search in the buffer.
+struct BufferMatch
+{
+	/// The line of the match.
+	int line;
+	/// The index of the first matched character in the line.
+	int start;
+	/// The count of matched characters.
+	int length;
+};
+
+/// The matches of a search in the whole buffer: sorted intervals of the lines that have matches.
+/// The index is kept up to date while the buffer is edited: only the edited lines are set again, the other lines are shifted.
+/// Finding the matches of a line and the next (or the previous) match costs O(log matches).
+class MatchIndex
+{
+public:
+	/// Remove all matches.
+	void Clear();
+
+	/// Return the count of matches.
+	size_t GetMatchCount() const;
+
+	/// Add matches in any order, for example the matches streamed by a background search.
+	/// Note: the lines of the matches must not have matches in the index yet.
+	void AddMatches(const std::vector<BufferMatch>& matches);
+	/// Replace the matches of the line. The matches must be sorted.
+	void SetLineMatches(int line, const std::vector<LineMatch>& matches);
+	/// Shift the matches after count lines were inserted before the line at.
+	void InsertLines(int at, int count);
+	/// Remove the matches of count lines starting at the line at, and shift the following ones.
+	void EraseLines(int at, int count);
+
+	/// Return the sorted matches of the line. Return nullptr if the line has no matches.
+	const std::vector<LineMatch>* GetLineMatches(int line) const;
+	/// Find the first match after (forward), or the last match before the position, wrapping around the buffer.
+	/// Return false if there are no matches.
+	bool FindNearest(int line, int x, bool forward, BufferMatch& result) const;
+
+private:
+	/// The sorted numbers of lines that have matches.
+	mutable std::vector<int> m_Lines;
+	/// The matches of lines, m_Matches[i] belongs to the line m_Lines[i].
+	mutable std::vector<std::vector<LineMatch>> m_Matches;
+	/// The added matches that are not merged into m_Lines and m_Matches yet.
+	mutable std::vector<BufferMatch> m_Pending;
+	/// The count of matches in m_Matches.
+	mutable size_t m_Count = 0;
+
+	/// Merge m_Pending into m_Lines and m_Matches.
+	void MergePending() const;
+	/// Return the index of the first element of m_Lines that is not less than the line.
+	size_t LowerBound(int line) const;
+};
+
+/// Find the first occurrence of needle in haystack that starts at or after start. Return -1 if there is no occurrence.
+/// Note: an empty needle is never found.
+/// Note: uses SIMD instructions when they are available (the first and the last byte of the needle are compared for 16 positions at once, then the candidates are verified).
+long FindSubstring(const char* haystack, size_t haystackSize, const char* needle, size_t needleSize, size_t start);
+
+/// Find the last occurrence of needle in haystack that starts before end. Return -1 if there is no occurrence.
+long FindLastSubstring(const char* haystack, size_t haystackSize, const char* needle, size_t needleSize, size_t end);
+
+#endif // EDITOR_SEARCH_HPP
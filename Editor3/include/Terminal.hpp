@@ -45,6 +45,7 @@ enum class TerminalFeature
 	LITERAL_SEND,          /// A way to send a key literally.
 	CR_NL_TRANSFORM,       /// Transform NL into CRNL.
 	OUTPUT_PROCESSING,     /// Different ways of processing the output.
+	SYNCHRONIZED_OUTPUT,   /// Show every flushed output at once (DEC mode 2026), if the terminal supports it.
 };
 
 /// Information about key in key events.
@@ -110,7 +111,7 @@ struct TerminalCoord
 };
 
 /// Representation of a color in a terminal.
-// TODO: How TerminalColor struct (or class) should be defined? What if the user wants to use not RGB or not 256 values?
+/// Note: the colors are RGB, a terminal that shows less colors maps them to the nearest colors of its palette.
 struct TerminalColor
 {
 	/// The red channel of the color.
@@ -164,8 +165,18 @@ public:
 	// TODO: DOCUMENT.
 	virtual TerminalKey WaitAndReadKey() = 0;
 
+	/// Wait until a key may be read or the timeout expires (instant operation). The timeout measured in miliseconds.
+	/// Return true if there is a key to read.
+	virtual bool WaitForKey(int timeout) = 0;
+
 	/// Perform all buferred operations at once (instant operation).
+	/// Note: the implementation may write the output in background, then it reaches the terminal later, but in order.
 	virtual void Flush() = 0;
+	/// Return the time until the flushed output is expected to reach the terminal (instant operation). The time measured in miliseconds.
+	/// Return 0 if the output is not backed up, so the next frame may be drawn.
+	virtual int GetOutputDelay() = 0;
+	/// Wait until the output of the flushed operations is written to the terminal (instant operation).
+	virtual void WaitForOutput() = 0;
 	
 	/// Buffered operations:
 	
@@ -200,6 +211,8 @@ public:
 	virtual void WriteCharVector(const std::vector<char>& vector) = 0;
 	/// Print a part of a vector of chars as a string (buffered operation).
 	virtual void WriteCharVector(const std::vector<char>& vector, size_t start, size_t length) = 0;
+	/// Print count characters (buffered operation).
+	virtual void WriteChars(const char* chars, size_t count) = 0;
 	
 	/// Set the color of characters for next text.
 	/// Note: the implementation may not show the exact color, but it should show the closest possible color to the color argument.
@@ -0,0 +1,63 @@
+/*
+ * TerminalColors.hpp - the escape sequences of the colors for the color depth of a terminal.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_TERMINAL_COLORS_HPP
+#define EDITOR_TERMINAL_COLORS_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "Terminal.hpp"
+
+/// How many colors a terminal can show.
+enum class TerminalColorDepth
+{
+	TRUE_COLOR, /// Any RGB color: ESC [ 38;2;r;g;b m.
+	COLORS_256, /// The xterm palette of 256 colors: ESC [ 38;5;n m.
+	COLORS_16,  /// The 8 basic colors and their bright variants: ESC [ 3n m and ESC [ 9n m.
+};
+
+/// Return the color depth of the terminal described by the values of the TERM and COLORTERM environment variables (may be nullptr).
+TerminalColorDepth DetectColorDepth(const char* term, const char* colorTerm);
+
+/// Return the color of the xterm palette at index (0 - 255).
+TerminalColor GetPaletteColor(int index);
+
+/// Writes the shortest escape sequences of the colors for a color depth. The RGB colors are mapped to the palette through precomputed tables.
+/// A color that is already set is not written again.
+class TerminalColorEncoder
+{
+public:
+	/// Create an encoder for the depth. No color is known to be set.
+	TerminalColorEncoder(TerminalColorDepth depth = TerminalColorDepth::TRUE_COLOR);
+
+	/// Return the color depth.
+	TerminalColorDepth GetDepth() const
+	{ return m_Depth; }
+	/// Change the color depth. No color is known to be set.
+	void SetDepth(TerminalColorDepth depth);
+
+	/// Append the sequence that sets the color of characters, unless it is set.
+	void WriteForeground(TerminalColor color, std::string& output);
+	/// Append the sequence that sets the color of background, unless it is set.
+	void WriteBackground(TerminalColor color, std::string& output);
+	/// Forget the set colors. Should be called after the attributes of the terminal were reset.
+	void Reset();
+
+private:
+	/// The color depth of the terminal.
+	TerminalColorDepth m_Depth;
+	/// The set colors: 0xRRGGBB for TRUE_COLOR or the index in the palette. -1 if unknown.
+	int32_t m_Foreground = -1;
+	int32_t m_Background = -1;
+
+	/// Append the sequence of the color, unless it is current. Then it becomes current.
+	void Write(TerminalColor color, bool background, int32_t& current, std::string& output);
+};
+
+#endif // EDITOR_TERMINAL_COLORS_HPP
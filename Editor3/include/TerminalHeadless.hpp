@@ -0,0 +1,169 @@
+/*
+ * TerminalHeadless.hpp - a terminal in memory for benchmarks and tests.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_TERMINAL_HEADLESS_HPP
+#define EDITOR_TERMINAL_HEADLESS_HPP
+
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "Terminal.hpp"
+#include "TerminalColors.hpp"
+
+/// A character of the screen of a HeadlessTerminal with its colors.
+struct HeadlessCell
+{
+	char character = ' ';
+	TerminalColor foreground = { 255, 255, 255 };
+	TerminalColor background = { 0, 0, 0 };
+};
+
+/// A terminal without a TTY. The output is written as the escape sequences of a real terminal, and Flush parses them into a grid of cells.
+/// The keys are taken from a script, and the count of written bytes is recorded for every flush (a frame).
+/// Note: like a real terminal, the grid shows only the flushed output.
+/// The class is final, so the editor that draws on it by its type calls its methods directly.
+class HeadlessTerminal final : public Terminal
+{
+public:
+	/// Create a terminal of the size with an empty screen.
+	HeadlessTerminal(TerminalCoord size);
+
+	/// Change the size, as if the window was resized. The cells that fit the new size are kept.
+	void SetSize(TerminalCoord size);
+
+	/// Enable or disable the grid. Without the grid Flush only counts the bytes of the frame, so a benchmark measures the editor alone.
+	void SetGridEnabled(bool enabled)
+	{ m_GridEnabled = enabled; }
+
+	/// Change the color depth of the output, so the frames are written as for a real terminal of the depth. Truecolor by default.
+	void SetColorDepth(TerminalColorDepth depth)
+	{ m_ColorEncoder.SetDepth(depth); }
+
+	/// Add the key to the end of the script.
+	void PushKey(TerminalKey key);
+	/// Add the characters of the text to the end of the script, as if they were typed.
+	void PushText(const std::string& text);
+	/// Return the count of the keys that were not read yet.
+	size_t GetPendingKeyCount() const
+	{ return m_Keys.size(); }
+
+	/// Return the cell of the screen.
+	const HeadlessCell& GetCell(TerminalCoord coord) const
+	{ return m_Cells[coord.y * m_Size.x + coord.x]; }
+	/// Return the characters of the screen row y.
+	std::string GetRowText(int y) const;
+	/// Return true if the cursor is shown.
+	bool IsCursorVisible() const
+	{ return m_CursorVisible; }
+
+	/// Return the count of bytes written by every Flush.
+	const std::vector<size_t>& GetFrameBytes() const
+	{ return m_FrameBytes; }
+	/// Return the bytes written by the last Flush. Empty if the grid is disabled.
+	const std::string& GetLastFrame() const
+	{ return m_LastFrame; }
+	/// Forget the recorded frames.
+	void ClearFrameBytes();
+
+	virtual const TerminalCoord GetSize() override;
+	virtual void EnableFeature(TerminalFeature feature) override;
+	virtual void DisableFeature(TerminalFeature feature) override;
+	virtual void SetReadTimeout(int timeout) override;
+	/// Return the cursor after the last Flush.
+	virtual const TerminalCoord GetCursorPosition() override;
+	/// Return the next key of the script. Throw an UnrecoverableTerminalImplementationError if the script is over.
+	virtual TerminalKey WaitAndReadKey() override;
+	/// Return true if the script has keys. Never waits.
+	virtual bool WaitForKey(int timeout) override;
+	virtual void Flush() override;
+	/// Return 0, Flush writes the output at once.
+	virtual int GetOutputDelay() override;
+	/// Return at once, Flush writes the output.
+	virtual void WaitForOutput() override;
+
+	virtual void ClearScreen() override;
+	virtual void ClearCurrentRow() override;
+	virtual void RevertAllAttributes() override;
+	virtual void SetCursorPosition(TerminalCoord coord) override;
+	virtual void HideCursor() override;
+	virtual void ShowCursor() override;
+	virtual void WriteCharacter(char character) override;
+	virtual void WriteString(const std::string& str) override;
+	virtual void WriteString(const std::string& str, size_t start, size_t length) override;
+	virtual void WriteCharVector(const std::vector<char>& vector) override;
+	virtual void WriteCharVector(const std::vector<char>& vector, size_t start, size_t length) override;
+	virtual void WriteChars(const char* chars, size_t count) override;
+	virtual void SetForegroundColor(TerminalColor color) override;
+	virtual void SetBackgroundColor(TerminalColor color) override;
+
+private:
+	/// The size of the screen.
+	TerminalCoord m_Size;
+	/// The cells of the screen row by row.
+	std::vector<HeadlessCell> m_Cells;
+	/// Is the output parsed into m_Cells.
+	bool m_GridEnabled = true;
+	/// The scripted keys.
+	std::deque<TerminalKey> m_Keys;
+
+	/// The output of the buffered operations until Flush.
+	std::string m_Output;
+	/// Writes the colors for the color depth.
+	TerminalColorEncoder m_ColorEncoder;
+	/// The output of the last Flush.
+	std::string m_LastFrame;
+	/// The count of bytes of every Flush.
+	std::vector<size_t> m_FrameBytes;
+
+	/// The states of the parser of the output.
+	enum class ParserState
+	{
+		GROUND, /// Printing the characters.
+		ESCAPE, /// After ESC.
+		CSI,    /// Inside a control sequence (ESC [).
+	};
+
+	/// The maximum count of parameters of a control sequence, the rest is ignored.
+	static constexpr int MAX_PARAMETERS = 16;
+
+	/// The state of the parser. It is kept between the flushes, so a sequence may be split between them.
+	ParserState m_State = ParserState::GROUND;
+	/// The parameters of the current control sequence.
+	int m_Parameters[MAX_PARAMETERS];
+	/// The count of the parameters of the current control sequence.
+	int m_ParameterCount = 0;
+	/// Does the current control sequence start with '?' (a private mode).
+	bool m_PrivateSequence = false;
+
+	/// The cursor of the parsed output.
+	TerminalCoord m_Cursor = { 0, 0 };
+	/// Was the last column written, so the next character goes to the next row.
+	bool m_WrapPending = false;
+	/// Is the cursor shown.
+	bool m_CursorVisible = true;
+	/// The colors of the next characters.
+	HeadlessCell m_Attributes;
+
+	/// Apply the byte of the output to the screen.
+	void Parse(char ch);
+	/// Apply the control sequence with the final character.
+	void ExecuteSequence(char final);
+	/// Apply the parameters of a SGR sequence (ESC [ ... m).
+	void ExecuteGraphicRendition();
+	/// Print the character at the cursor.
+	void Print(char ch);
+	/// Move the cursor to the next row, the screen is scrolled at the bottom.
+	void LineFeed();
+	/// Clear the cells [from; to) of the row y with the current background.
+	void ClearCells(int y, int from, int to);
+	/// Return the parameter at index or the value if it is missing or zero.
+	int GetParameter(int index, int value) const;
+};
+
+#endif // EDITOR_TERMINAL_HEADLESS_HPP
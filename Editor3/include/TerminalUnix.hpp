@@ -0,0 +1,677 @@
+/*
+ * TerminalUnix.hpp - a standard terminal implementation for UNIX systems.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_TERMINAL_UNIX_HPP
+#define EDITOR_TERMINAL_UNIX_HPP
+
+#ifdef EDITOR_COMPILE_UNIX
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <poll.h>
+#include <termios.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "Terminal.hpp"
+#include "TerminalColors.hpp"
+
+// TODO: Ctrl-H maybe mapped to backspace.
+
+/// The rate at which the output drains is assumed until a write blocks (in bytes per second).
+#define OUTPUT_INITIAL_DRAIN_RATE 100000000.0
+/// A write that takes longer measures the rate at which the output drains (in seconds).
+#define OUTPUT_MEASURED_WRITE_TIME 0.001
+/// The longest delay returned by GetOutputDelay, so the backlog is checked again (in miliseconds).
+#define OUTPUT_MAX_DELAY 100
+/// The time to wait for every byte of the answer to the query of the synchronized output (in miliseconds).
+#define SYNCHRONIZED_OUTPUT_QUERY_TIMEOUT 200
+/// The sequences that begin and end a synchronized update.
+#define SYNCHRONIZED_UPDATE_BEGIN "\x1b[?2026h"
+#define SYNCHRONIZED_UPDATE_END "\x1b[?2026l"
+
+/// The terminal of the standard input and output.
+/// Note: the class is final and defined in the header, so the editor that draws on it by its type inlines its methods.
+class UnixTerminal final : public Terminal
+{
+public:
+	UnixTerminal()
+		: m_ColorEncoder(DetectColorDepth(getenv("TERM"), getenv("COLORTERM")))
+	{
+		m_Writer = std::thread(&UnixTerminal::WriterLoop, this);
+	}
+	
+	virtual ~UnixTerminal() override
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_OutputMutex);
+			m_OutputWritten.wait(lock, [this] { return (m_Pending.empty() && !m_Writing) || m_WriteFailed; });
+			m_Stopping = true;
+		}
+		m_OutputReady.notify_one();
+		m_Writer.join();
+	}
+	
+	virtual void DisableFeature(TerminalFeature feature) override
+	{
+		if (feature == TerminalFeature::SYNCHRONIZED_OUTPUT)
+		{
+			std::lock_guard<std::mutex> lock(m_OutputMutex);
+			m_SynchronizedOutput = false;
+			return;
+		}
+
+		// The change of the state waits for the output, so the frames are written first.
+		this->WaitForOutput();
+
+		struct termios cur;
+		if (tcgetattr(STDIN_FILENO, &cur) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the state of the terminal");
+		}
+
+		switch (feature)
+		{
+		case TerminalFeature::ECHOING:
+			cur.c_lflag &= ~(ECHO);
+			break;
+		case TerminalFeature::CANONICAL_MODE:
+			cur.c_lflag &= ~(ICANON);
+			break;
+		case TerminalFeature::SIGNALS:
+			cur.c_lflag &= ~(ISIG);
+			break;
+		case TerminalFeature::SOFTWARE_FLOW_CONTROL:
+			cur.c_iflag &= ~(IXON);
+			break;
+		case TerminalFeature::LITERAL_SEND:
+			cur.c_lflag &= ~(IEXTEN);
+			break;
+		case TerminalFeature::CR_NL_TRANSFORM:
+			cur.c_iflag &= ~(ICRNL);
+			break;
+		case TerminalFeature::OUTPUT_PROCESSING:
+			cur.c_oflag &= ~(OPOST);
+			break;
+		case TerminalFeature::SYNCHRONIZED_OUTPUT:
+			// Handled above, it is not a state of the TTY.
+			break;
+		}
+		
+		if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &cur) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to change the state of the terminal");
+		}
+	}
+
+	virtual void EnableFeature(TerminalFeature feature) override
+	{
+		if (feature == TerminalFeature::SYNCHRONIZED_OUTPUT)
+		{
+			bool supported = this->QuerySynchronizedOutput();
+			std::lock_guard<std::mutex> lock(m_OutputMutex);
+			m_SynchronizedOutput = supported;
+			return;
+		}
+
+		this->WaitForOutput();
+
+		struct termios cur;
+		if (tcgetattr(STDIN_FILENO, &cur) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the state of the terminal");
+		}
+
+		switch (feature)
+		{
+		case TerminalFeature::ECHOING:
+			cur.c_lflag |= (ECHO);
+			break;
+		case TerminalFeature::CANONICAL_MODE:
+			cur.c_lflag |= (ICANON);
+			break;
+		case TerminalFeature::SIGNALS:
+			cur.c_lflag |= (ISIG);
+			break;
+		case TerminalFeature::SOFTWARE_FLOW_CONTROL:
+			cur.c_iflag |= (IXON);
+			break;
+		case TerminalFeature::LITERAL_SEND:
+			cur.c_lflag |= (IEXTEN);
+			break;
+		case TerminalFeature::CR_NL_TRANSFORM:
+			cur.c_iflag |= (ICRNL);
+			break;
+		case TerminalFeature::OUTPUT_PROCESSING:
+			cur.c_oflag |= (OPOST);
+			break;
+		case TerminalFeature::SYNCHRONIZED_OUTPUT:
+			// Handled above, it is not a state of the TTY.
+			break;
+		}
+		
+		if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &cur) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to change the state of the terminal");
+		}
+	}
+
+	virtual void SetReadTimeout(int timeout) override
+	{
+		this->WaitForOutput();
+
+		struct termios cur;
+		if (tcgetattr(STDIN_FILENO, &cur) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the state of the terminal");
+		}
+		
+		cur.c_cc[VMIN] = 0;
+		cur.c_cc[VTIME] = timeout / 100;
+
+		if (tcsetattr(STDIN_FILENO, TCSAFLUSH, &cur) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to change the state of the terminal");
+		}
+	}
+
+	virtual TerminalKey WaitAndReadKey() override
+	{
+		int nread;
+		int c = 0;
+		while((nread = read(STDIN_FILENO, &c, 1)) != 1)
+		{
+			if (nread == -1 && errno != EAGAIN)
+			{
+				throw UnrecoverableTerminalImplementationError("unable to read a character from the terminal");
+			}
+		}
+
+		if (c == '\x1b')
+		{
+			return WaitAndReadEscapeSequence();
+		}
+		
+		return MakeKey(c);
+	}
+
+	virtual bool WaitForKey(int timeout) override
+	{
+		struct pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+
+		int result = poll(&fd, 1, timeout);
+		if (result == -1 && errno != EINTR)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to wait for the input of the terminal");
+		}
+
+		return result > 0;
+	}
+
+	virtual const TerminalCoord GetSize() override
+	{
+		struct winsize ws;
+
+		if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1 || ws.ws_col == 0)
+		{
+			return GetSizeFallback();	
+		}
+		else
+		{
+			return { ws.ws_col, ws.ws_row };
+		}
+	}
+
+	virtual const TerminalCoord GetCursorPosition() override
+	{
+		char buf[16];
+		int i = 0;
+
+		this->WaitForOutput();
+		if (write(STDOUT_FILENO, "\x1b[6n", 4) != 4)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the size of the terminal");
+		}
+		
+		while (i < sizeof(buf) - 1)
+		{
+			if (read(STDIN_FILENO, &buf[i], 1) != 1)
+			{
+				break;
+			}
+			if (buf[i] == 'R')
+			{
+				break;
+			}
+			i++;
+		}
+		
+		buf[i] = '\0';
+
+		if (buf[0] != '\x1b' || buf[1] != '[')
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the size of the terminal");
+		}
+
+		TerminalCoord size;
+		if (sscanf(&buf[2], "%d;%d", &size.x, &size.y) != 2)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the size of the terminal");
+		}
+
+		return size;
+	}
+	
+	virtual void ClearScreen() override
+	{
+		this->WaitForOutput();
+		if (write(STDOUT_FILENO, "\x1b[2J", 4) == -1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to clear the screen of the terminal");
+		}
+	}
+
+	virtual void SetCursorPosition(TerminalCoord coord) override
+	{
+		char buffer[16];
+
+		int result = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH", coord.y + 1, coord.x + 1);
+		if (result > sizeof(buffer) || result < 0) // TODO: Is that right comparison?
+		{
+			throw UnrecoverableTerminalImplementationError("unable to change the position of the cursor because it is too big to form a message to the terminal");
+		}
+
+		m_Buffer.append(buffer, result);
+	}
+
+	virtual void WriteCharacter(char character) override
+	{
+		// TODO: What if the user sends an escape sequence to the terminal?
+		m_Buffer += character;
+	}
+
+	virtual void WriteString(const std::string& str) override
+	{
+		this->WriteString(str, 0, str.size());
+	}
+
+	virtual void WriteCharVector(const std::vector<char>& vector) override
+	{
+		this->WriteCharVector(vector, 0, vector.size());
+	}
+	
+	virtual void WriteString(const std::string& str, size_t start, size_t length) override
+	{
+		m_Buffer.append(str, start, length);
+	}
+
+	virtual void WriteCharVector(const std::vector<char>& vector, size_t start, size_t length) override
+	{
+		m_Buffer.append(vector.data() + start, length);
+	}
+
+	virtual void WriteChars(const char* chars, size_t count) override
+	{
+		m_Buffer.append(chars, count);
+	}
+	
+	virtual void HideCursor() override
+	{
+		m_Buffer += "\x1b[?25l";
+	}
+	
+	virtual void ShowCursor() override
+	{
+		m_Buffer += "\x1b[?25h";
+	}
+
+	virtual void ClearCurrentRow() override
+	{
+		m_Buffer += "\x1b[K";
+	}
+
+	/// Hand the output to the writer thread and return without waiting for it to be written.
+	/// The output of the frames that wait for the writer is joined, so a slow terminal gets them in one write.
+	/// Note: a waiting frame is never dropped, because the frames of the editor only draw what changed since the previous frame.
+	virtual void Flush() override
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_OutputMutex);
+			if (m_WriteFailed)
+			{
+				throw UnrecoverableTerminalImplementationError("unable to write to the terminal");
+			}
+
+			if (m_Pending.empty())
+			{
+				// The buffers are swapped and keep their capacity, so the next frames are written without allocations.
+				std::swap(m_Pending, m_Buffer);
+			}
+			else
+			{
+				m_Pending += m_Buffer;
+				m_Buffer.clear();
+			}
+		}
+		m_OutputReady.notify_one();
+	}
+
+	/// The backlog is the output that waits for the writer and the output queued by the TTY driver (TIOCOUTQ).
+	/// The delay is the time to drain it at the rate measured by the writes that blocked.
+	virtual int GetOutputDelay() override
+	{
+		std::lock_guard<std::mutex> lock(m_OutputMutex);
+		size_t backlog = m_Pending.size() + (m_Writing ? m_WritingSize : 0);
+#ifdef TIOCOUTQ
+		int queued = 0;
+		if (ioctl(STDOUT_FILENO, TIOCOUTQ, &queued) == 0 && queued > 0)
+		{
+			backlog += queued;
+		}
+#endif
+		if (backlog == 0)
+		{
+			return 0;
+		}
+
+		int delay = static_cast<int>(backlog / m_DrainRate * 1000);
+		// A frame already waits for the writer, the next one would only be joined to it.
+		if (!m_Pending.empty() && delay == 0)
+		{
+			delay = 1;
+		}
+		return delay < OUTPUT_MAX_DELAY ? delay : OUTPUT_MAX_DELAY;
+	}
+
+	virtual void WaitForOutput() override
+	{
+		std::unique_lock<std::mutex> lock(m_OutputMutex);
+		m_OutputWritten.wait(lock, [this] { return (m_Pending.empty() && !m_Writing) || m_WriteFailed; });
+		if (m_WriteFailed)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to write to the terminal");
+		}
+	}
+
+	virtual void SetForegroundColor(TerminalColor color) override
+	{
+		m_ColorEncoder.WriteForeground(color, m_Buffer);
+	}
+
+	virtual void SetBackgroundColor(TerminalColor color) override
+	{
+		m_ColorEncoder.WriteBackground(color, m_Buffer);
+	}
+
+	virtual void RevertAllAttributes() override
+	{
+		m_Buffer += "\x1b[m";
+		m_ColorEncoder.Reset();
+	}
+	
+private:
+	/// The output of the buffered operations until Flush.
+	std::string m_Buffer;
+
+	/// The thread that writes the flushed output, so the editor does not wait for a slow terminal.
+	std::thread m_Writer;
+	/// Guards the members below.
+	std::mutex m_OutputMutex;
+	/// Notified when there is output to write or the writer should stop.
+	std::condition_variable m_OutputReady;
+	/// Notified when the writer has written its output.
+	std::condition_variable m_OutputWritten;
+	/// The flushed output that waits for the writer.
+	std::string m_Pending;
+	/// The output that is being written. Only used by the writer thread.
+	std::string m_Written;
+	/// Is the writer writing m_Written.
+	bool m_Writing = false;
+	/// The size of m_Written while it is written.
+	size_t m_WritingSize = 0;
+	/// The measured rate at which the output drains (in bytes per second).
+	double m_DrainRate = OUTPUT_INITIAL_DRAIN_RATE;
+	/// Has a write failed. The error is thrown by the next Flush or WaitForOutput.
+	bool m_WriteFailed = false;
+	/// Should the writer thread stop.
+	bool m_Stopping = false;
+	/// Is every write wrapped into a synchronized update.
+	bool m_SynchronizedOutput = false;
+	/// Writes the colors for the color depth of the terminal, detected from the environment.
+	TerminalColorEncoder m_ColorEncoder;
+
+	/// The main function of the writer thread.
+	void WriterLoop()
+	{
+		std::unique_lock<std::mutex> lock(m_OutputMutex);
+		while (true)
+		{
+			m_OutputReady.wait(lock, [this] { return !m_Pending.empty() || m_Stopping; });
+			if (m_Stopping)
+			{
+				return;
+			}
+
+			std::swap(m_Written, m_Pending);
+			if (m_SynchronizedOutput)
+			{
+				// The terminal shows the joined frames at once, so a frame is never seen half drawn.
+				m_Written.insert(0, SYNCHRONIZED_UPDATE_BEGIN);
+				m_Written += SYNCHRONIZED_UPDATE_END;
+			}
+			m_Writing = true;
+			m_WritingSize = m_Written.size();
+			lock.unlock();
+
+			auto start = std::chrono::steady_clock::now();
+			bool failed = !WriteAll(m_Written.data(), m_Written.size());
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			lock.lock();
+			this->UpdateDrainRate(m_Written.size(), seconds);
+			m_Written.clear();
+			m_Writing = false;
+			m_WriteFailed = m_WriteFailed || failed;
+			m_OutputWritten.notify_all();
+		}
+	}
+
+	/// Ask the terminal whether it supports the synchronized output (DEC mode 2026). Should be called in the raw mode.
+	bool QuerySynchronizedOutput()
+	{
+		// DECRQM asks for the state of the mode. Then DA1 is asked, because every terminal answers it,
+		// so the answers are read up to the end of the DA1 answer ('c') and a terminal that ignores DECRQM is not waited for.
+		static const char QUERY[] = "\x1b[?2026$p\x1b[c";
+
+		this->WaitForOutput();
+		if (write(STDOUT_FILENO, QUERY, sizeof(QUERY) - 1) != sizeof(QUERY) - 1)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to query the modes of the terminal");
+		}
+
+		char answer[64];
+		size_t size = 0;
+		while (size < sizeof(answer) - 1 && this->WaitForKey(SYNCHRONIZED_OUTPUT_QUERY_TIMEOUT))
+		{
+			if (read(STDIN_FILENO, &answer[size], 1) != 1)
+			{
+				break;
+			}
+			if (answer[size++] == 'c')
+			{
+				break;
+			}
+		}
+		answer[size] = '\0';
+
+		// The answer is ESC [ ? 2026 ; Ps $ y, the mode is supported if Ps is 1 (set) or 2 (reset).
+		return strstr(answer, "\x1b[?2026;1$y") != nullptr || strstr(answer, "\x1b[?2026;2$y") != nullptr;
+	}
+
+	/// Update the drain rate with a write of size bytes that took the seconds.
+	/// A write that blocked measures the rate. A fast write only shows that the rate is not less than it.
+	void UpdateDrainRate(size_t size, double seconds)
+	{
+		if (seconds >= OUTPUT_MEASURED_WRITE_TIME)
+		{
+			m_DrainRate = (m_DrainRate + size / seconds) / 2;
+		}
+		else if (size / OUTPUT_MEASURED_WRITE_TIME > m_DrainRate)
+		{
+			m_DrainRate = size / OUTPUT_MEASURED_WRITE_TIME;
+		}
+	}
+
+	/// Write all the bytes to the standard output. Return false on an error.
+	static bool WriteAll(const char* data, size_t size)
+	{
+		while (size > 0)
+		{
+			ssize_t result = write(STDOUT_FILENO, data, size);
+			if (result == -1 && errno == EINTR)
+			{
+				continue;
+			}
+			if (result <= 0)
+			{
+				return false;
+			}
+			data += result;
+			size -= result;
+		}
+		return true;
+	}
+
+	/// Fallback, if the ioctl call does not work.
+	const TerminalCoord GetSizeFallback()
+	{
+		this->WaitForOutput();
+		if (write(STDOUT_FILENO, "\x1b[999C\x1b[999B", 12) != 12)
+		{
+			throw UnrecoverableTerminalImplementationError("unable to get the size of the terminal");
+		}
+
+		return GetCursorPosition();
+	}
+
+	/// Convert raw key value to TerminalKey.
+	TerminalKey MakeKey(int c)
+	{
+		// TODO: Support for Alt.
+
+		if (c == '\t')
+		{
+			return TerminalKey(c, false, false);
+		}
+		if (c == TerminalKeys::ESCAPE)
+		{
+			return TerminalKey(c, false, false);
+		}
+		if (c == (c & 0x1F)) // TODO: Probably CTRL key checking is unsafe, was bug with tab. Tab is equal to some Ctrl key.
+		{
+			return TerminalKey(c + 96, true, false);
+		}
+		else if (c == 127)
+		{
+			return TerminalKey(TerminalKeys::BACKSPACE, false, false);
+		}
+		else
+		{
+			return TerminalKey(c, false, false);
+		}
+	}
+
+	/// Read the key that is represented by escape sequence.
+	TerminalKey WaitAndReadEscapeSequence()
+	{
+		char seq[3];
+
+		if (read(STDIN_FILENO, &seq[0], 1) != 1)
+		{
+			return MakeKey('\x1b');
+		}
+
+		if (read(STDIN_FILENO, &seq[1], 1) != 1)
+		{
+			return MakeKey('\x1b');
+		}
+
+		if (seq[0] == '[')
+		{
+			if (seq[1] >= '0' && seq[1] <= '9')
+			{
+				if (read(STDIN_FILENO, &seq[2], 1) != 1)
+				{
+					return MakeKey('\x1b');
+				}
+
+				if (seq[2] == '~')
+				{
+					switch (seq[1])
+					{
+					case '1':
+					case '7':
+						return MakeKey(TerminalKeys::HOME);
+					case '3':
+						return MakeKey(TerminalKeys::DELETE);
+					case '4':
+					case '8':
+						return MakeKey(TerminalKeys::END);
+					case '5':
+						return MakeKey(TerminalKeys::PAGE_UP);
+					case '6':
+						return MakeKey(TerminalKeys::PAGE_DOWN);
+					default:
+						return MakeKey('\x1b');
+					}
+				}			
+			}
+		
+			switch (seq[1])
+			{
+			case 'A':
+				return MakeKey(TerminalKeys::ARROW_UP);
+			case 'B':
+				return MakeKey(TerminalKeys::ARROW_DOWN);
+			case 'C':
+				return MakeKey(TerminalKeys::ARROW_RIGHT);
+			case 'D':
+				return MakeKey(TerminalKeys::ARROW_LEFT);
+			case 'H':
+				return MakeKey(TerminalKeys::HOME);
+			case 'F':
+				return MakeKey(TerminalKeys::END);
+			}
+		}
+		else if (seq[0] == 'O')
+		{
+			switch (seq[1])
+			{
+			case 'H':
+				return MakeKey(TerminalKeys::HOME);
+			case 'F':
+				return MakeKey(TerminalKeys::END);
+			}
+		}
+
+		return MakeKey('\x1b');
+	}
+};
+
+#endif // EDITOR_COMPILE_UNIX
+
+#endif // EDITOR_TERMINAL_UNIX_HPP
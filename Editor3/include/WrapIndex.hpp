@@ -0,0 +1,71 @@
+/*
+ * WrapIndex.hpp - the screen lines of the rows that are wrapped at the width of a view.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#ifndef EDITOR_WRAP_INDEX_HPP
+#define EDITOR_WRAP_INDEX_HPP
+
+#include <vector>
+
+/// The layout of the rows when a row wider than the view continues on the next screen lines.
+/// Keeps the render width and the count of lines of every row, and the prefix sums of the counts in a Fenwick tree,
+/// so the first line of a row and the row of a line are found in O(log n).
+/// Note: a row of width w takes w / width + 1 lines, so the cursor after the last character always has a cell.
+/// The lines after the last row belong to the rows after it (like the row of the cursor at the end of the buffer), one line each.
+class WrapIndex
+{
+public:
+	/// Return the count of rows.
+	int GetRowCount() const
+	{ return m_Widths.size(); }
+	/// Return the width of the lines.
+	int GetWidth() const
+	{ return m_Width; }
+	/// Return the count of lines of all rows.
+	int GetLineCount() const
+	{ return m_LineCount; }
+	/// Return the count of lines of the row.
+	int GetRowLineCount(int row) const
+	{ return row < this->GetRowCount() ? m_Lines[row] : 1; }
+
+	/// Return the first line of the row. O(log n).
+	int GetFirstLine(int row) const;
+	/// Return the row that has the line. O(log n).
+	int FindRow(int line) const;
+
+	/// Replace the rows with the rows of the render widths, wrapped at width. O(n).
+	void Assign(const std::vector<int>& widths, int width);
+	/// Wrap the rows at the width. Only the counts of lines are computed again, the rows are not measured. O(n).
+	void SetWidth(int width);
+	/// Change the render width of the row. Return true if its count of lines was changed. O(log n).
+	bool SetRowWidth(int row, int width);
+	/// Insert count rows of zero width at row (count > 0) or erase -count rows from row (count < 0).
+	/// Only the nodes of the tree after row are computed again, so it is O(n - row) and an edit at the end of the buffer is cheap.
+	void ShiftRows(int row, int count);
+
+private:
+	/// The width of the lines.
+	int m_Width = 1;
+	/// The render width of every row.
+	std::vector<int> m_Widths;
+	/// The count of lines of every row.
+	std::vector<int> m_Lines;
+	/// The Fenwick tree of m_Lines: m_Tree[i] is the sum of the counts of the rows (i - (i & -i); i].
+	std::vector<int> m_Tree;
+	/// The sum of m_Lines.
+	int m_LineCount = 0;
+
+	/// Return the count of lines of a row of the width.
+	int CountLines(int width) const
+	{ return width / m_Width + 1; }
+	/// Compute the counts of lines and the tree from m_Widths. O(n).
+	void Build();
+	/// Compute the nodes of the tree after the first row from m_Lines, the nodes before it are kept. O(n - row).
+	void BuildTree(int row);
+};
+
+#endif // EDITOR_WRAP_INDEX_HPP
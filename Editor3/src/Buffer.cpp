@@ -0,0 +1,855 @@
+/*
+ * Buffer.cpp - the text of a file that is shown by the views.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Buffer.hpp>
+#include <Search.hpp>
+
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+/// The count of rows that an edit highlights at once, the rest is highlighted in the background.
+#define HIGHLIGHT_SYNC_ROWS 256
+/// The count of rows that are given to the background highlighter at once.
+#define HIGHLIGHT_JOB_ROWS 8192
+
+Buffer::Buffer(const std::filesystem::path& filePath)
+	: m_FilePath(std::filesystem::absolute(filePath)),
+	  m_FileName(filePath.filename())
+{
+	m_Syntax = FindHighlightSyntax(m_FileName);
+}
+
+void Buffer::Load()
+{
+	if (m_Loaded)
+	{
+		return;
+	}
+	
+	std::ifstream file(m_FilePath);
+	if (!file)
+	{
+		m_NewFile = true;
+		m_Loaded = true;
+		this->CheckUndoHistory();
+		return;
+	}
+
+	m_NewFile = false;
+
+   	// TODO: Line endings.
+	std::string lineOfFile;
+	while (std::getline(file, lineOfFile))
+	{
+		this->AppendRow(lineOfFile);
+	}
+
+	if (file.fail() && !file.eof())
+	{
+		m_Rows.clear();
+		throw EditorFileIOError("an error occured while reading the file");
+	}
+
+	m_Loaded = true;
+	this->CheckUndoHistory();
+
+	// The rows are highlighted in the background, starting with the visible ones.
+	this->AddHighlightPending(0);
+
+	// The views of a reloaded buffer draw the rows again.
+	this->NotifyRowsChanged(0, m_Rows.size());
+}
+
+bool Buffer::Unload()
+{
+	if (!m_Loaded || m_Dirty)
+	{
+		return false;
+	}
+
+	// The file may be changed before it is read again, then the undo history does not match it.
+	this->GetFileStatus(m_UnloadedFileSize, m_UnloadedFileTime);
+	m_UndoMergeable = false;
+
+	// The memory is given back only by a swap, clear keeps the capacity.
+	std::vector<Row>().swap(m_Rows);
+	m_RowPool.Clear();
+	
+	m_HighlightWorker = nullptr;
+	m_HighlightVersion++;
+	m_HighlightPending.clear();
+	std::vector<HighlightStyle>().swap(m_HighlightStyles);
+	std::vector<HighlightSpan>().swap(m_HighlightSpans);
+
+	m_Loaded = false;
+	return true;
+}
+
+void Buffer::GetFileStatus(std::uintmax_t& size, std::filesystem::file_time_type& time) const
+{
+	// The error overloads return -1 and min() if the file does not exist, so a missing file matches a missing file.
+	std::error_code error;
+	size = std::filesystem::file_size(m_FilePath, error);
+	time = std::filesystem::last_write_time(m_FilePath, error);
+}
+
+void Buffer::CheckUndoHistory()
+{
+	if (m_UndoStack.empty())
+	{
+		return;
+	}
+
+	std::uintmax_t size;
+	std::filesystem::file_time_type time;
+	this->GetFileStatus(size, time);
+	if (size != m_UnloadedFileSize || time != m_UnloadedFileTime)
+	{
+		m_UndoStack.clear();
+	}
+}
+
+size_t Buffer::GetMemoryUsage() const
+{
+	size_t usage = m_Rows.capacity() * sizeof(Row) + m_RowPool.GetAllocatedSize();
+	for (const Row& row : m_Rows)
+	{
+		usage += row.highlight.capacity() * sizeof(HighlightSpan);
+		if (row.columns != nullptr)
+		{
+			usage += sizeof(RenderColumns) + (row.real.size() / RENDER_COLUMNS_STEP + 1) * sizeof(int);
+		}
+	}
+
+	for (const UndoRecord& record : m_UndoStack)
+	{
+		for (const UndoHunk& hunk : record.hunks)
+		{
+			usage += sizeof(UndoHunk);
+			for (const std::vector<char>& line : hunk.oldLines)
+			{
+				usage += sizeof(line) + line.capacity();
+			}
+		}
+	}
+
+	return usage;
+}
+
+void Buffer::Save()
+{
+	std::ofstream file(m_FilePath);
+	if (!file)
+	{
+		throw EditorFileIOError("unable to write to the file");
+	}
+
+	for (Row& row : m_Rows)
+	{
+		// TODO: Different types of line endings to save.
+		for (char ch : row.real)
+		{
+			file << ch;
+		}
+
+		file << "\n";
+
+		if (file.fail())
+		{
+			throw EditorFileIOError("an error occured during the write to the file");
+		}
+	}
+
+	m_Dirty = false;
+}
+
+void Buffer::SetTabStop(int newSize)
+{
+	if (newSize == m_TabStop)
+	{
+		return;
+	}
+
+	if (newSize <= 0)
+	{
+		throw std::out_of_range("new tab stop size is 0 or negative, but should be greater than 0");
+	}
+
+	m_TabStop = newSize;
+
+	for (Row& row : m_Rows)
+	{
+		this->UpdateRow(row);
+	}
+
+	// The spans are stored in render characters, so all of them are moved by the new tabs.
+	for (Row& row : m_Rows)
+	{
+		row.highlightState = HighlightState::UNKNOWN;
+	}
+	m_HighlightVersion++;
+	m_HighlightPending.clear();
+	this->AddHighlightPending(0);
+
+	this->NotifyRowsRestyled(0, m_Rows.size());
+}
+
+int Buffer::RowCxToRx(const Row& row, int cx, int fromCx, int fromRx) const
+{
+	if (row.columns != nullptr)
+	{
+		if (!row.columns->HasTabs())
+		{
+			return cx;
+		}
+
+		int checkpointCx, checkpointRx;
+		row.columns->FindByCx(cx, checkpointCx, checkpointRx);
+		if (checkpointCx > fromCx)
+		{
+			fromCx = checkpointCx;
+			fromRx = checkpointRx;
+		}
+	}
+
+	int rx = fromRx;
+	for (int i = fromCx; i < cx; i++)
+	{
+		if (row.real[i] == '\t')
+		{
+			// **** TabStop
+			// **   (rx % ts)
+			//   ** ts - (rx % ts)
+			rx += m_TabStop - (rx % m_TabStop);
+		}
+		else
+		{
+			rx++;
+		}
+	}
+
+	return rx;
+}
+
+int Buffer::RowRxToCx(const Row& row, int rx) const
+{
+	int size = row.real.size();
+	int cx = 0;
+	int cxRx = 0;
+	if (row.columns != nullptr)
+	{
+		if (!row.columns->HasTabs())
+		{
+			return rx < size ? rx : size;
+		}
+
+		row.columns->FindByRx(rx, cx, cxRx);
+	}
+
+	for (; cx < size; cx++)
+	{
+		int nextRx = row.real[cx] == '\t' ? cxRx + m_TabStop - (cxRx % m_TabStop) : cxRx + 1;
+		if (nextRx > rx)
+		{
+			break;
+		}
+		cxRx = nextRx;
+	}
+
+	return cx;
+}
+
+void Buffer::AddListener(BufferListener* listener)
+{
+	m_Listeners.push_back(listener);
+}
+
+void Buffer::RemoveListener(BufferListener* listener)
+{
+	m_Listeners.erase(std::remove(m_Listeners.begin(), m_Listeners.end(), listener), m_Listeners.end());
+}
+
+void Buffer::NotifyRowsChanged(int first, int count)
+{
+	for (BufferListener* listener : m_Listeners)
+	{
+		listener->OnRowsChanged(first, count);
+	}
+}
+
+void Buffer::NotifyRowsRestyled(int first, int count)
+{
+	for (BufferListener* listener : m_Listeners)
+	{
+		listener->OnRowsRestyled(first, count);
+	}
+}
+
+void Buffer::ShiftRows(int y, int count)
+{
+	m_HighlightVersion++;
+	for (int& pending : m_HighlightPending)
+	{
+		if (pending >= y)
+		{
+			pending = count > 0 || pending + count >= y ? pending + count : y;
+		}
+	}
+	m_HighlightPending.erase(std::unique(m_HighlightPending.begin(), m_HighlightPending.end()), m_HighlightPending.end());
+
+	for (BufferListener* listener : m_Listeners)
+	{
+		listener->OnRowsShifted(y, count);
+	}
+}
+
+void Buffer::AppendRow(const std::string& str)
+{
+	m_Rows.emplace_back(&m_RowPool);
+
+	m_Rows.back().real.assign(str.begin(), str.end());
+	this->UpdateRow(m_Rows.back());
+}
+
+void Buffer::UpdateRow(Row& row, int from)
+{
+	RenderPolicy::Update(row.real, row.render, m_TabStop);
+
+	if (row.real.size() >= RENDER_COLUMNS_MIN_SIZE)
+	{
+		// The checkpoints may be shared with a copy of the row, then they are copied on write.
+		if (row.columns != nullptr && row.columns.use_count() == 1)
+		{
+			row.columns->Update(row.real.data(), row.real.size(), m_TabStop, from);
+		}
+		else
+		{
+			row.columns = std::make_shared<RenderColumns>(row.real.data(), row.real.size(), m_TabStop);
+		}
+	}
+	else
+	{
+		row.columns.reset();
+	}
+}
+
+void Buffer::RowInsertChar(Row& row, int at, char ch)
+{
+	if (at < 0)
+	{
+		at = 0;
+	}
+
+	if (at > row.real.size())
+	{
+		at = row.real.size();
+	}
+
+	row.real.insert(row.real.begin() + at, ch);
+
+	this->UpdateRow(row, at);
+}
+
+void Buffer::RowDeleteChar(Row& row, int at)
+{
+	if (at < 0 || at > row.real.size())
+	{
+		return;
+	}
+
+	row.real.erase(row.real.begin() + at);
+	m_Dirty = true;
+	this->UpdateRow(row, at);
+}
+
+void Buffer::InsertChar(TerminalCoord at, char ch)
+{
+	if (at.y == m_Rows.size())
+	{
+		this->RecordUndo(at, at.y, 0, 1);
+		this->AppendRow("");
+		this->ShiftRows(at.y, 1);
+	}
+	else
+	{
+		this->RecordUndo(at, at.y, 1, 1, true);
+	}
+
+	this->RowInsertChar(m_Rows[at.y], at.x, ch);
+	this->NotifyRowsChanged(at.y, 1);
+	this->HighlightRows(at.y, 1);
+	m_Dirty = true;
+}
+
+void Buffer::DeleteChar(TerminalCoord at)
+{
+	// TODO: Bug when there is no text, but only one line is left.
+	if (at.y >= m_Rows.size()
+		|| (at.y == 0 && at.x == 0))
+	{
+		return;
+	}
+
+	if (at.x > 0)
+	{
+		this->RecordUndo(at, at.y, 1, 1, true);
+		this->RowDeleteChar(m_Rows[at.y], at.x - 1);
+		this->NotifyRowsChanged(at.y, 1);
+		this->HighlightRows(at.y, 1);
+	}
+	else
+	{
+		this->RecordUndo(at, at.y - 1, 2, 1);
+
+		Row& previousRow = m_Rows[at.y - 1];
+		Row& currentRow  = m_Rows[at.y];
+
+		int joinedAt = previousRow.real.size();
+		previousRow.real.insert(previousRow.real.end(), currentRow.real.begin(), currentRow.real.end());
+		previousRow.highlightState = currentRow.highlightState;
+		m_Rows.erase(m_Rows.begin() + at.y);
+		this->UpdateRow(m_Rows[at.y - 1], joinedAt);
+		this->ShiftRows(at.y, -1);
+		this->NotifyRowsChanged(at.y - 1, 1);
+		this->HighlightRows(at.y - 1, 1);
+		m_Dirty = true;
+	}
+}
+
+void Buffer::InsertNewLine(TerminalCoord at)
+{
+	if (at.x == 0)
+	{
+		this->RecordUndo(at, at.y, 0, 1);
+		m_Rows.insert(m_Rows.begin() + at.y, Row(&m_RowPool));
+		this->ShiftRows(at.y, 1);
+		this->HighlightRows(at.y, 1);
+	}
+	else
+	{
+		this->RecordUndo(at, at.y, 1, 2);
+		m_Rows.insert(m_Rows.begin() + at.y + 1, Row(&m_RowPool));
+
+		Row& currentRow = m_Rows[at.y];
+		Row& newRow = m_Rows[at.y + 1];
+
+		newRow.real.insert(newRow.real.end(), currentRow.real.begin() + at.x, currentRow.real.end());
+		currentRow.real.erase(currentRow.real.begin() + at.x, currentRow.real.end());
+
+		this->UpdateRow(currentRow, at.x);
+		this->UpdateRow(newRow);
+		this->ShiftRows(at.y + 1, 1);
+		this->NotifyRowsChanged(at.y, 2);
+		this->HighlightRows(at.y, 2);
+	}
+
+	m_Dirty = true;
+}
+
+void Buffer::RecordUndo(TerminalCoord cursor, int first, int oldCount, int newCount, bool mergeable)
+{
+	// The typing inside the line of the last typing only changes that line again, its record already has the line before it.
+	if (mergeable && m_UndoMergeable && !m_UndoStack.empty())
+	{
+		const UndoRecord& last = m_UndoStack.back();
+		if (last.hunks.size() == 1 && last.hunks[0].first == first)
+		{
+			return;
+		}
+	}
+	m_UndoMergeable = mergeable;
+
+	UndoHunk hunk;
+	hunk.first = first;
+	hunk.newCount = newCount;
+	for (int i = first; i < first + oldCount; i++)
+	{
+		hunk.oldLines.emplace_back(m_Rows[i].real.begin(), m_Rows[i].real.end());
+	}
+
+	m_UndoStack.push_back(UndoRecord());
+	m_UndoStack.back().hunks.push_back(std::move(hunk));
+	m_UndoStack.back().cursor = cursor;
+}
+
+bool Buffer::Undo(TerminalCoord& cursor)
+{
+	if (m_UndoStack.empty())
+	{
+		return false;
+	}
+
+	UndoRecord& record = m_UndoStack.back();
+	for (auto hunk = record.hunks.rbegin(); hunk != record.hunks.rend(); hunk++)
+	{
+		int oldCount = hunk->oldLines.size();
+		int common = oldCount < hunk->newCount ? oldCount : hunk->newCount;
+
+		for (int i = 0; i < common; i++)
+		{
+			m_Rows[hunk->first + i].real.assign(hunk->oldLines[i].begin(), hunk->oldLines[i].end());
+			this->UpdateRow(m_Rows[hunk->first + i]);
+		}
+
+		if (hunk->newCount > oldCount)
+		{
+			m_Rows.erase(m_Rows.begin() + hunk->first + common, m_Rows.begin() + hunk->first + hunk->newCount);
+			this->ShiftRows(hunk->first + common, oldCount - hunk->newCount);
+		}
+		else if (oldCount > hunk->newCount)
+		{
+			m_Rows.insert(m_Rows.begin() + hunk->first + common, oldCount - common, Row(&m_RowPool));
+			for (int i = common; i < oldCount; i++)
+			{
+				m_Rows[hunk->first + i].real.assign(hunk->oldLines[i].begin(), hunk->oldLines[i].end());
+				this->UpdateRow(m_Rows[hunk->first + i]);
+			}
+			this->ShiftRows(hunk->first + common, oldCount - hunk->newCount);
+		}
+
+		for (int i = 0; i < oldCount; i++)
+		{
+			m_Rows[hunk->first + i].highlightState = HighlightState::UNKNOWN;
+		}
+		this->NotifyRowsChanged(hunk->first, oldCount);
+		this->HighlightRows(hunk->first, oldCount > 0 ? oldCount : 1);
+	}
+
+	cursor = record.cursor;
+	m_UndoStack.pop_back();
+	m_UndoMergeable = false;
+	m_Dirty = true;
+	return true;
+}
+
+size_t Buffer::ReplaceAll(const std::string& query, const std::string& replacement, TerminalCoord cursor, int& changedLines)
+{
+	changedLines = 0;
+	if (query.empty())
+	{
+		return 0;
+	}
+
+	int threadCount = std::thread::hardware_concurrency();
+	if (threadCount <= 0)
+	{
+		threadCount = 1;
+	}
+	int chunkSize = (m_Rows.size() + threadCount - 1) / threadCount;
+
+	// Every thread builds the changed lines of its chunk and keeps the old lines for the undo.
+	// The new lines are stored into the rows by this thread, m_RowPool is not thread safe.
+	struct ChunkResult
+	{
+		std::vector<UndoHunk> hunks;
+		std::vector<std::vector<char>> lines;
+		size_t replaced = 0;
+	};
+	std::vector<ChunkResult> results(threadCount);
+
+	auto replaceChunk = [&](int chunk)
+	{
+		int first = chunk * chunkSize;
+		int last = first + chunkSize < m_Rows.size() ? first + chunkSize : m_Rows.size();
+
+		for (int y = first; y < last; y++)
+		{
+			const Row& row = m_Rows[y];
+			long match = FindSubstring(row.real.data(), row.real.size(), query.data(), query.size(), 0);
+			if (match == -1)
+			{
+				continue;
+			}
+
+			std::vector<char> line;
+			line.reserve(row.real.size());
+
+			size_t copied = 0;
+			while (match != -1)
+			{
+				line.insert(line.end(), row.real.begin() + copied, row.real.begin() + match);
+				line.insert(line.end(), replacement.begin(), replacement.end());
+				copied = match + query.size();
+				results[chunk].replaced++;
+
+				match = FindSubstring(row.real.data(), row.real.size(), query.data(), query.size(), copied);
+			}
+			line.insert(line.end(), row.real.begin() + copied, row.real.end());
+
+			UndoHunk hunk;
+			hunk.first = y;
+			hunk.newCount = 1;
+			hunk.oldLines.emplace_back(row.real.begin(), row.real.end());
+			results[chunk].hunks.push_back(std::move(hunk));
+			results[chunk].lines.push_back(std::move(line));
+		}
+	};
+
+	std::vector<std::thread> threads;
+	for (int chunk = 1; chunk < threadCount; chunk++)
+	{
+		threads.emplace_back(replaceChunk, chunk);
+	}
+	replaceChunk(0);
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	UndoRecord record;
+	record.cursor = cursor;
+	size_t replaced = 0;
+	for (ChunkResult& result : results)
+	{
+		replaced += result.replaced;
+		for (size_t i = 0; i < result.hunks.size(); i++)
+		{
+			UndoHunk& hunk = result.hunks[i];
+			Row& row = m_Rows[hunk.first];
+			row.real.assign(result.lines[i].begin(), result.lines[i].end());
+			this->UpdateRow(row);
+
+			this->NotifyRowsChanged(hunk.first, 1);
+			this->HighlightRows(hunk.first, 1);
+			record.hunks.push_back(std::move(hunk));
+		}
+	}
+
+	if (replaced == 0)
+	{
+		return 0;
+	}
+
+	changedLines = record.hunks.size();
+	m_UndoStack.push_back(std::move(record));
+	m_UndoMergeable = false;
+	m_Dirty = true;
+	return replaced;
+}
+
+void Buffer::HighlightRows(int y, int count)
+{
+	if (m_Syntax == nullptr)
+	{
+		return;
+	}
+
+	m_HighlightVersion++;
+
+	HighlightState state = y > 0 ? m_Rows[y - 1].highlightState : HighlightState::NORMAL;
+	if (state == HighlightState::UNKNOWN)
+	{
+		state = HighlightState::NORMAL;
+	}
+
+	int first = y;
+	for (int end = y + count, budget = HIGHLIGHT_SYNC_ROWS; y < m_Rows.size(); y++, budget--)
+	{
+		// A huge row is lexed by the worker, so a keystroke on it does not wait for the whole row.
+		if (budget == 0 || m_Rows[y].real.size() >= RENDER_COLUMNS_MIN_SIZE)
+		{
+			this->AddHighlightPending(y);
+			break;
+		}
+
+		Row& row = m_Rows[y];
+		RenderChars render = this->GetRender(row, m_HighlightRender);
+		if (m_HighlightStyles.size() < render.size)
+		{
+			m_HighlightStyles.resize(render.size);
+		}
+
+		HighlightState newState = HighlightLine(*m_Syntax, render.data, render.size, state, m_HighlightStyles.data());
+		m_HighlightSpans.clear();
+		AppendHighlightSpans(m_HighlightStyles.data(), render.size, m_HighlightSpans);
+		row.highlight.assign(m_HighlightSpans.begin(), m_HighlightSpans.end());
+
+		bool changed = newState != row.highlightState;
+		row.highlightState = newState;
+		state = newState;
+
+		// The next row was highlighted from the cached state, so it is still correct.
+		bool nextHighlighted = y + 1 == m_Rows.size() || m_Rows[y + 1].highlightState != HighlightState::UNKNOWN;
+		if (y >= end - 1 && !changed && nextHighlighted)
+		{
+			y++;
+			break;
+		}
+	}
+
+	this->NotifyRowsRestyled(first, y - first);
+}
+
+void Buffer::AddHighlightPending(int y)
+{
+	if (m_Syntax == nullptr || y >= m_Rows.size())
+	{
+		return;
+	}
+
+	auto at = std::lower_bound(m_HighlightPending.begin(), m_HighlightPending.end(), y);
+	if (at == m_HighlightPending.end() || *at != y)
+	{
+		m_HighlightPending.insert(at, y);
+	}
+}
+
+void Buffer::RemoveHighlightPending(int first, int last)
+{
+	auto from = std::lower_bound(m_HighlightPending.begin(), m_HighlightPending.end(), first);
+	auto to = std::upper_bound(m_HighlightPending.begin(), m_HighlightPending.end(), last);
+	m_HighlightPending.erase(from, to);
+}
+
+bool Buffer::HasHighlightWork(int first, int count) const
+{
+	if (m_Syntax == nullptr)
+	{
+		return false;
+	}
+
+	if (!m_HighlightPending.empty() || (m_HighlightWorker != nullptr && m_HighlightWorker->IsBusy()))
+	{
+		return true;
+	}
+
+	for (int y = first; y < first + count && y < m_Rows.size(); y++)
+	{
+		if (m_Rows[y].highlightState == HighlightState::UNKNOWN)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Buffer::ProcessHighlightWork(std::chrono::steady_clock::time_point deadline, int first, int count)
+{
+	if (m_Syntax == nullptr)
+	{
+		return;
+	}
+
+	if (m_HighlightWorker == nullptr)
+	{
+		m_HighlightWorker = std::make_unique<HighlightWorker>(*m_Syntax);
+	}
+
+	while (true)
+	{
+		if (m_HighlightWorker->IsBusy())
+		{
+			int timeout = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+
+			HighlightWorker::Result result;
+			if (!m_HighlightWorker->TakeResult(result, timeout > 0 ? timeout : 0))
+			{
+				return;
+			}
+
+			// The rows were changed after the job was given, so its rows may be not the same.
+			if (result.version == m_HighlightVersion)
+			{
+				this->ApplyHighlight(result);
+			}
+		}
+
+		if (std::chrono::steady_clock::now() >= deadline)
+		{
+			return;
+		}
+
+		// The visible rows are highlighted first: from a pending row inside them, or from the first not highlighted visible row.
+		int visibleEnd = first + count;
+		if (visibleEnd > m_Rows.size())
+		{
+			visibleEnd = m_Rows.size();
+		}
+
+		int start = -1;
+		auto pendingVisible = std::lower_bound(m_HighlightPending.begin(), m_HighlightPending.end(), first);
+		if (pendingVisible != m_HighlightPending.end() && *pendingVisible < visibleEnd)
+		{
+			start = *pendingVisible;
+		}
+
+		for (int y = first; start == -1 && y < visibleEnd; y++)
+		{
+			if (m_Rows[y].highlightState == HighlightState::UNKNOWN)
+			{
+				start = y;
+			}
+		}
+
+		// Then the rest of the rows while the editor is idle.
+		if (start == -1 && !m_HighlightPending.empty())
+		{
+			start = m_HighlightPending.front();
+		}
+
+		if (start == -1)
+		{
+			return;
+		}
+
+		HighlightWorker::Job job;
+		job.version = m_HighlightVersion;
+		job.firstRow = start;
+		job.startState = start > 0 ? m_Rows[start - 1].highlightState : HighlightState::NORMAL;
+		if (job.startState == HighlightState::UNKNOWN)
+		{
+			// The row above is not highlighted yet, so the state is a guess. It is corrected when the highlighting reaches this row from above.
+			job.startState = HighlightState::NORMAL;
+		}
+
+		for (int y = start; y < start + HIGHLIGHT_JOB_ROWS && y < m_Rows.size(); y++)
+		{
+			RenderChars render = this->GetRender(m_Rows[y], m_HighlightRender);
+			job.lines.emplace_back(render.data, render.data + render.size);
+		}
+
+		m_HighlightWorker->Start(std::move(job));
+	}
+}
+
+int Buffer::ApplyHighlight(const HighlightWorker::Result& result)
+{
+	int first = result.firstRow;
+	int y = first;
+	int applied = -1;
+	const HighlightSpan* spans = result.spans.data();
+	for (size_t i = 0; i < result.endStates.size(); i++, y++)
+	{
+		Row& row = m_Rows[y];
+		bool changed = result.endStates[i] != row.highlightState;
+		row.highlight.assign(spans, spans + result.spanCounts[i]);
+		row.highlightState = result.endStates[i];
+		spans += result.spanCounts[i];
+
+		bool nextHighlighted = y + 1 == m_Rows.size() || m_Rows[y + 1].highlightState != HighlightState::UNKNOWN;
+		if (!changed && nextHighlighted)
+		{
+			this->RemoveHighlightPending(first, y);
+			applied = y - first + 1;
+			break;
+		}
+	}
+
+	if (applied == -1)
+	{
+		this->RemoveHighlightPending(first, y - 1);
+		this->AddHighlightPending(y);
+		applied = y - first;
+	}
+
+	this->NotifyRowsRestyled(first, applied);
+	return applied;
+}
@@ -0,0 +1,603 @@
+/*
+ * BufferView.cpp - a view of a buffer with its own cursor, scroll position and damage.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <BufferView.hpp>
+
+#include <cassert>
+
+BufferView::BufferView(std::shared_ptr<Buffer> buffer)
+	: m_Buffer(std::move(buffer))
+{
+	m_Buffer->AddListener(this);
+}
+
+BufferView::~BufferView()
+{
+	m_Buffer->RemoveListener(this);
+}
+
+void BufferView::SetCursor(TerminalCoord cursor)
+{
+	m_Cursor = cursor;
+	m_Buffer->EndUndoMerge();
+}
+
+void BufferView::SetOffset(TerminalCoord offset)
+{
+	if (offset.x != m_Offset.x || offset.y != m_Offset.y)
+	{
+		m_Offset = offset;
+		m_OffsetLine = 0;
+		this->Invalidate();
+	}
+}
+
+void BufferView::ClampToBuffer()
+{
+	this->ClampCursor();
+
+	// A view that starts after the last row would show nothing of the file, so its last page is shown.
+	int rowCount = m_Buffer->GetRowCount();
+	if (m_Offset.y >= rowCount && m_Offset.y > 0)
+	{
+		int lastPage = rowCount - m_Size.y + 1;
+		lastPage = lastPage < 0 ? 0 : lastPage;
+		this->SetOffset({ m_Offset.x, lastPage < m_Offset.y ? lastPage : m_Offset.y });
+	}
+}
+
+TerminalCoord BufferView::GetCursorOnScreen() const
+{
+	if (!m_Wrapped)
+	{
+		return { m_Rx - m_Offset.x, m_Cursor.y - m_Offset.y };
+	}
+
+	int width = m_Wrap.GetWidth();
+	return { m_Rx % width, m_Wrap.GetFirstLine(m_Cursor.y) + m_Rx / width - this->GetTopLine() };
+}
+
+TerminalCoord BufferView::GetRowStart(int y) const
+{
+	if (!m_Wrapped)
+	{
+		return { m_Offset.x, m_Offset.y + y };
+	}
+
+	int line = this->GetTopLine() + y;
+	int row = m_Wrap.FindRow(line);
+	return { (line - m_Wrap.GetFirstLine(row)) * m_Wrap.GetWidth(), row };
+}
+
+void BufferView::SetWrapped(bool wrapped)
+{
+	if (wrapped == m_Wrapped)
+	{
+		return;
+	}
+
+	m_Wrapped = wrapped;
+	m_Offset.x = 0;
+	m_OffsetLine = 0;
+	// The rows are measured when the view is scrolled, and the memory is freed when the rows are not wrapped.
+	m_Wrap = WrapIndex();
+	m_WrapTabStop = 0;
+	this->Invalidate();
+}
+
+void BufferView::MoveCursor(TerminalKey key)
+{
+	// TODO: 2 modes: free move and only line move.
+	// TODO: Word jump.
+	// TODO: Save last cursor pos, if entered a small line.
+
+	this->ClampCursor();
+	m_Buffer->EndUndoMerge();
+
+	int rowCount = m_Buffer->GetRowCount();
+	const Buffer::Chars* line = (m_Cursor.y >= rowCount ? nullptr : &m_Buffer->GetRow(m_Cursor.y).real);
+
+	switch (key.GetChar())
+	{
+	case TerminalKeys::ARROW_UP:
+	case 'w':
+		if (m_Cursor.y != 0)
+		{
+			m_Cursor.y--;
+		}
+		break;
+	case TerminalKeys::ARROW_LEFT:
+	case 'a':
+		if (m_Cursor.x != 0)
+		{
+			m_Cursor.x--;
+		}
+		else if (m_Cursor.y > 0)
+		{
+			m_Cursor.y--;
+			m_Cursor.x = m_Buffer->GetRow(m_Cursor.y).real.size();
+		}
+		break;
+	case TerminalKeys::ARROW_DOWN:
+	case 's':
+		if (m_Cursor.y < rowCount)
+		{
+			m_Cursor.y++;
+		}
+		break;
+	case TerminalKeys::ARROW_RIGHT:
+	case 'd':
+		if (line != nullptr && m_Cursor.x < line->size())
+		{
+			m_Cursor.x++;
+		}
+		else if (line != nullptr && m_Cursor.x == line->size())
+		{
+			m_Cursor.y++;
+			m_Cursor.x = 0;
+		}
+		break;
+	case TerminalKeys::PAGE_UP:
+	case TerminalKeys::PAGE_DOWN:
+	{
+		if (m_Wrapped)
+		{
+			this->MovePageWrapped(key.GetChar() == TerminalKeys::PAGE_UP);
+			break;
+		}
+
+		// The page starts at the offset of the scrolled view, which is not scrolled yet if the keys came faster than the frames.
+		this->Scroll();
+		if (key.GetChar() == TerminalKeys::PAGE_UP)
+		{
+			m_Cursor.y = m_Offset.y;
+		}
+		else
+		{
+			m_Cursor.y = m_Offset.y + m_Size.y - 1;
+			if (m_Cursor.y > rowCount)
+			{
+				m_Cursor.y = rowCount;
+			}
+		}
+
+		int times = m_Size.y;
+		while (times--)
+		{
+			this->MoveCursor(TerminalKey(key.GetChar() == TerminalKeys::PAGE_UP ? TerminalKeys::ARROW_UP : TerminalKeys::ARROW_DOWN, false, false));
+		}
+		break;
+	}
+	case TerminalKeys::HOME:
+		m_Cursor.x = 0;
+		break;
+	case TerminalKeys::END:
+		if (line != nullptr)
+		{
+			m_Cursor.x = line->size();
+		}
+		break;
+	default:
+		assert(false && "This should not be occured. Key argument is wrong, probably there is a mistake in switch in Editor::ProcessKey.");
+		break;
+	}
+
+	line = (m_Cursor.y >= rowCount ? nullptr : &m_Buffer->GetRow(m_Cursor.y).real);
+	int rowLength = line != nullptr ? line->size() : 0;
+	if (m_Cursor.x > rowLength)
+	{
+		m_Cursor.x = rowLength;
+	}
+}
+
+void BufferView::InsertChar(char ch)
+{
+	this->ClampCursor();
+
+	m_Editing = true;
+	m_Buffer->InsertChar(m_Cursor, ch);
+	m_Editing = false;
+
+	m_Cursor.x++;
+}
+
+void BufferView::DeleteChar()
+{
+	this->ClampCursor();
+	if (m_Cursor.y == m_Buffer->GetRowCount() || (m_Cursor.y == 0 && m_Cursor.x == 0))
+	{
+		return;
+	}
+
+	// The cursor goes to the joint of the rows.
+	TerminalCoord cursor = m_Cursor.x > 0
+		? TerminalCoord { m_Cursor.x - 1, m_Cursor.y }
+		: TerminalCoord { static_cast<int>(m_Buffer->GetRow(m_Cursor.y - 1).real.size()), m_Cursor.y - 1 };
+
+	m_Editing = true;
+	m_Buffer->DeleteChar(m_Cursor);
+	m_Editing = false;
+
+	m_Cursor = cursor;
+}
+
+void BufferView::InsertNewLine()
+{
+	this->ClampCursor();
+
+	m_Editing = true;
+	m_Buffer->InsertNewLine(m_Cursor);
+	m_Editing = false;
+
+	m_Cursor.y++;
+	m_Cursor.x = 0;
+}
+
+bool BufferView::Undo()
+{
+	m_Editing = true;
+	bool undone = m_Buffer->Undo(m_Cursor);
+	m_Editing = false;
+
+	return undone;
+}
+
+void BufferView::ClampCursor()
+{
+	int rowCount = m_Buffer->GetRowCount();
+	if (m_Cursor.y > rowCount)
+	{
+		m_Cursor.y = rowCount;
+	}
+
+	int rowLength = m_Cursor.y < rowCount ? m_Buffer->GetRow(m_Cursor.y).real.size() : 0;
+	if (m_Cursor.x > rowLength)
+	{
+		m_Cursor.x = rowLength;
+	}
+}
+
+void BufferView::Scroll()
+{
+	// TODO: Make two modes: 1-line scrolling and page scrolling.
+
+	if (m_Wrapped)
+	{
+		this->ScrollWrapped();
+		return;
+	}
+
+	this->ClampCursor();
+
+	if (m_Cursor.y < m_Buffer->GetRowCount())
+	{
+		m_Rx = m_Buffer->RowCxToRx(m_Buffer->GetRow(m_Cursor.y), m_Cursor.x);
+	}
+	else
+	{
+		m_Rx = 0;
+	}
+
+	TerminalCoord offset = m_Offset;
+
+	if (m_Cursor.y < offset.y)
+	{
+		offset.y = m_Cursor.y;
+	}
+
+	if (m_Cursor.y >= offset.y + m_Size.y)
+	{
+		offset.y = m_Cursor.y - m_Size.y + 1;
+	}
+
+	if (m_Rx < offset.x)
+	{
+		offset.x = m_Rx;
+	}
+
+	if (m_Rx >= offset.x + m_Size.x)
+	{
+		offset.x = m_Rx - m_Size.x + 1;
+	}
+
+	this->SetOffset(offset);
+}
+
+void BufferView::UpdateWrap()
+{
+	if (!m_Wrapped)
+	{
+		return;
+	}
+
+	int rowCount = m_Buffer->GetRowCount();
+	if (m_Wrap.GetRowCount() != rowCount || m_WrapTabStop != m_Buffer->GetTabStop())
+	{
+		std::vector<int> widths(rowCount);
+		for (int y = 0; y < rowCount; y++)
+		{
+			widths[y] = this->GetRowWidth(y);
+		}
+
+		m_Wrap.Assign(widths, m_Size.x);
+		m_WrapTabStop = m_Buffer->GetTabStop();
+		this->Invalidate();
+	}
+	else
+	{
+		// The widths of the rows do not depend on the width of the view, so only the counts of lines are computed again.
+		m_Wrap.SetWidth(m_Size.x);
+	}
+}
+
+int BufferView::GetRowWidth(int y) const
+{
+	const Buffer::Row& row = m_Buffer->GetRow(y);
+	return m_Buffer->RowCxToRx(row, row.real.size());
+}
+
+void BufferView::SetTopLine(int line)
+{
+	line = line < 0 ? 0 : line;
+	int row = m_Wrap.FindRow(line);
+	int rowLine = line - m_Wrap.GetFirstLine(row);
+	if (row != m_Offset.y || rowLine != m_OffsetLine || m_Offset.x != 0)
+	{
+		m_Offset = { 0, row };
+		m_OffsetLine = rowLine;
+		this->Invalidate();
+	}
+}
+
+void BufferView::ScrollWrapped()
+{
+	this->UpdateWrap();
+	this->ClampCursor();
+
+	int rowCount = m_Buffer->GetRowCount();
+	m_Rx = m_Cursor.y < rowCount ? m_Buffer->RowCxToRx(m_Buffer->GetRow(m_Cursor.y), m_Cursor.x) : 0;
+
+	// The first shown row could become shorter or be erased by another view.
+	if (m_Offset.y > rowCount)
+	{
+		this->SetOffset({ 0, rowCount });
+	}
+	if (m_OffsetLine >= m_Wrap.GetRowLineCount(m_Offset.y))
+	{
+		m_OffsetLine = m_Wrap.GetRowLineCount(m_Offset.y) - 1;
+		this->Invalidate();
+	}
+
+	int cursorLine = m_Wrap.GetFirstLine(m_Cursor.y) + m_Rx / m_Wrap.GetWidth();
+	int top = this->GetTopLine();
+	if (cursorLine < top)
+	{
+		top = cursorLine;
+	}
+	if (cursorLine >= top + m_Size.y)
+	{
+		top = cursorLine - m_Size.y + 1;
+	}
+
+	this->SetTopLine(top);
+}
+
+void BufferView::MovePageWrapped(bool up)
+{
+	// The page starts at the first or the last shown line, as without the wrapping.
+	this->ScrollWrapped();
+
+	int width = m_Wrap.GetWidth();
+	int line = up ? this->GetTopLine() - m_Size.y : this->GetTopLine() + 2 * m_Size.y - 1;
+	line = line < 0 ? 0 : line;
+	// The cursor may be on the row after the last one.
+	line = line > m_Wrap.GetLineCount() ? m_Wrap.GetLineCount() : line;
+
+	int row = m_Wrap.FindRow(line);
+	int rx = (line - m_Wrap.GetFirstLine(row)) * width + m_Rx % width;
+
+	// The character that covers the render column rx.
+	int cx = row < m_Buffer->GetRowCount() ? m_Buffer->RowRxToCx(m_Buffer->GetRow(row), rx) : 0;
+	m_Cursor = { cx, row };
+}
+
+BufferView* BufferView::Split(SplitType type)
+{
+	std::unique_ptr<BufferView> view = std::make_unique<BufferView>(m_Buffer);
+	view->m_Cursor = m_Cursor;
+	view->m_Offset = m_Offset;
+	view->m_Wrapped = m_Wrapped;
+	view->m_OffsetLine = m_OffsetLine;
+
+	// The new view is inserted between the view and its old child.
+	view->m_Child = std::move(m_Child);
+	view->m_Split = m_Split;
+
+	m_Child = std::move(view);
+	m_Split = type;
+	return m_Child.get();
+}
+
+void BufferView::CloseChild()
+{
+	if (m_Child == nullptr)
+	{
+		return;
+	}
+
+	std::unique_ptr<BufferView> child = std::move(m_Child);
+	m_Child = child->ReleaseChild();
+	if (m_Child == nullptr)
+	{
+		m_Split = SplitType::NONE;
+	}
+}
+
+std::unique_ptr<BufferView> BufferView::ReleaseChild()
+{
+	m_Split = SplitType::NONE;
+	return std::move(m_Child);
+}
+
+void BufferView::Layout(TerminalCoord position, TerminalCoord size)
+{
+	m_Position = position;
+	m_Size = size;
+
+	// One row or column between the views is the separator.
+	if (m_Split == SplitType::HORIZONTAL)
+	{
+		m_Size.y = size.y * m_SplitFactor;
+		m_Size.y = m_Size.y < 1 ? 1 : m_Size.y;
+		m_Size.y = m_Size.y > size.y - 2 ? size.y - 2 : m_Size.y;
+		m_Size.y = m_Size.y < 0 ? 0 : m_Size.y;
+
+		int childY = m_Size.y + 1 < size.y ? m_Size.y + 1 : size.y;
+		m_Child->Layout({ position.x, position.y + childY }, { size.x, size.y - childY });
+	}
+	else if (m_Split == SplitType::VERTICAL)
+	{
+		m_Size.x = size.x * m_SplitFactor;
+		m_Size.x = m_Size.x < 1 ? 1 : m_Size.x;
+		m_Size.x = m_Size.x > size.x - 2 ? size.x - 2 : m_Size.x;
+		m_Size.x = m_Size.x < 0 ? 0 : m_Size.x;
+
+		int childX = m_Size.x + 1 < size.x ? m_Size.x + 1 : size.x;
+		m_Child->Layout({ position.x + childX, position.y }, { size.x - childX, size.y });
+	}
+
+	m_SeparatorShown = (m_Split == SplitType::HORIZONTAL && m_Size.y < size.y) || (m_Split == SplitType::VERTICAL && m_Size.x < size.x);
+	m_DamagedRows.assign(m_Size.y, true);
+	m_SeparatorDamaged = true;
+
+	this->UpdateWrap();
+}
+
+void BufferView::Invalidate()
+{
+	m_DamagedRows.assign(m_Size.y, true);
+	m_SeparatorDamaged = true;
+}
+
+void BufferView::InvalidateRows(int first, int count)
+{
+	int from = first - m_Offset.y;
+	int to = first + count - m_Offset.y;
+	if (m_Wrapped)
+	{
+		int top = this->GetTopLine();
+		from = m_Wrap.GetFirstLine(first) - top;
+		to = m_Wrap.GetFirstLine(first + count) - top;
+	}
+	from = from < 0 ? 0 : from;
+	to = to > m_Size.y ? m_Size.y : to;
+
+	for (int y = from; y < to; y++)
+	{
+		m_DamagedRows[y] = true;
+	}
+}
+
+bool BufferView::IsDamaged() const
+{
+	if (this->IsSeparatorDamaged())
+	{
+		return true;
+	}
+
+	for (bool damaged : m_DamagedRows)
+	{
+		if (damaged)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void BufferView::ClearDamage()
+{
+	m_DamagedRows.assign(m_Size.y, false);
+	m_SeparatorDamaged = false;
+}
+
+void BufferView::OnRowsChanged(int first, int count)
+{
+	int rowCount = m_Buffer->GetRowCount();
+	if (m_Wrapped && m_Wrap.GetRowCount() == rowCount)
+	{
+		// If a row takes another count of lines, then the rows below it move.
+		bool moved = false;
+		for (int y = first; y < first + count; y++)
+		{
+			moved = m_Wrap.SetRowWidth(y, this->GetRowWidth(y)) || moved;
+		}
+		if (moved)
+		{
+			count = rowCount + m_Size.y - first;
+		}
+	}
+	this->UpdateWrap();
+
+	this->InvalidateRows(first, count);
+}
+
+void BufferView::OnRowsRestyled(int first, int count)
+{
+	// The tab stop could be changed.
+	this->UpdateWrap();
+
+	this->InvalidateRows(first, count);
+}
+
+void BufferView::OnRowsShifted(int y, int count)
+{
+	if (m_Wrapped && m_Wrap.GetRowCount() + count == m_Buffer->GetRowCount())
+	{
+		m_Wrap.ShiftRows(y, count);
+		for (int i = y; i < y + count; i++)
+		{
+			m_Wrap.SetRowWidth(i, this->GetRowWidth(i));
+		}
+	}
+
+	int erasedEnd = count < 0 ? y - count : y;
+
+	// The rows above the view were inserted or erased: the view keeps showing the same rows, so nothing is redrawn.
+	if (erasedEnd <= m_Offset.y && y < m_Offset.y && !m_Editing)
+	{
+		m_Offset.y += count;
+	}
+	else if (count < 0 && y < m_Offset.y && !m_Editing)
+	{
+		// The first shown rows were erased.
+		m_Offset.y = y;
+		m_OffsetLine = 0;
+		this->Invalidate();
+	}
+	else
+	{
+		// The rows below y are moved.
+		this->InvalidateRows(y, m_Offset.y + m_Size.y - y);
+	}
+
+	if (m_Editing || m_Cursor.y < y)
+	{
+		return;
+	}
+
+	if (count > 0 || m_Cursor.y >= erasedEnd)
+	{
+		m_Cursor.y += count;
+	}
+	else
+	{
+		// The row of the cursor was erased.
+		m_Cursor.y = y;
+	}
+}
@@ -1,62 +1,118 @@
 #include "Editor.hpp"
+#include "Search.hpp"
+#include "TerminalHeadless.hpp"
+#include "TerminalUnix.hpp"
 
 #include <cassert>
-#include <iomanip>
-#include <fstream>
+#include <charconv>
+#include <algorithm>
+#include <tuple>
 
 #define WELCOME_MESSAGE "Welcome to the Editor! Version 0.0.1."
-#define HELP_MESSAGE "HELP: Ctrl-Q - exit | Ctrl-S - save file."
+/// The time that ProcessBackgroundWork may spend on the highlighting (in milliseconds).
+#define HIGHLIGHT_WORK_TIME 20
 
-Editor::Editor(const std::filesystem::path& filePath)
-	: m_FilePath(std::filesystem::absolute(filePath)),
-	  m_FileName(filePath.filename())
+#define HELP_MESSAGE "HELP: Ctrl-Q - exit | Ctrl-S - save file | Ctrl-F - find | Ctrl-G - regex find | Ctrl-N/Ctrl-P - next/previous match | Ctrl-T - replace | Ctrl-Z - undo | Ctrl-R - record macro | Ctrl-E - replay macro | Ctrl-O/Ctrl-V - split horizontally/vertically | Ctrl-W - next view | Ctrl-K - close view | Ctrl-B/Ctrl-Y - next/previous file | Ctrl-L - wrap long lines."
+
+Editor::Editor(const std::vector<std::filesystem::path>& filePaths, size_t memoryBudget)
+	: m_MemoryBudget(memoryBudget)
 {
-	std::ifstream file(filePath);
-	if (!file)
-	{
-		this->ShowMessage("New file: '" + filePath.string() + "'. " HELP_MESSAGE, 1);
-		return;
-	}
+	assert(!filePaths.empty() && "The editor needs at least one file.");
 	
-   	// TODO: Line endings.
-	std::string lineOfFile;
-	while (std::getline(file, lineOfFile))
+	for (const std::filesystem::path& filePath : filePaths)
 	{
-		this->AppendRow(lineOfFile);
+		OpenBuffer open;
+		open.buffer = std::make_shared<Buffer>(filePath);
+		open.rootView = std::make_unique<BufferView>(open.buffer);
+		open.activeView = open.rootView.get();
+		m_Buffers.push_back(std::move(open));
 	}
 
-	if (file.fail() && !file.eof())
+	m_Buffer = m_Buffers[0].buffer;
+	m_ActiveView = m_Buffers[0].activeView;
+	m_Buffer->Load();
+	m_Buffer->AddListener(this);
+
+	if (m_Buffer->IsNewFile())
+	{
+		this->ShowMessage("New file: '" + filePaths[0].string() + "'. " HELP_MESSAGE, 1);
+	}
+	else
 	{
-		throw EditorFileIOError("an error occured while reading the file");
+		this->ShowMessage(HELP_MESSAGE, 1);
 	}
+}
 
-	this->ShowMessage(HELP_MESSAGE, 1);
+Editor::~Editor()
+{
+	m_Buffer->RemoveListener(this);
 }
 
-void Editor::RefreshScreen(std::shared_ptr<Terminal> terminal)
+template <typename TerminalType>
+void Editor::RefreshScreen(TerminalType& terminal)
 {
-	m_TerminalSize = terminal->GetSize();
-	m_BufferArea = m_TerminalSize;
-	m_BufferArea.y -= 2;
+	TerminalCoord size = terminal.GetSize();
+	if (size.x != m_TerminalSize.x || size.y != m_TerminalSize.y)
+	{
+		m_TerminalSize = size;
+		this->LayoutViews();
 
-	terminal->SetBackgroundColor(m_BackgroundColor);
-	terminal->SetForegroundColor(m_ForegroundColor);
-	
-	this->Scroll();
+		// The bars are drawn again with the new width.
+		m_DrawnStatusBar.clear();
+		m_DrawnMessageBar.clear();
+	}
+
+	bool damaged = false;
+	for (BufferView* view = this->GetRootView(); view != nullptr; view = view->GetChild())
+	{
+		view->Scroll();
+		damaged = damaged || view->IsDamaged();
+	}
 
-	terminal->HideCursor();
-	terminal->SetCursorPosition({ 0, 0 });
+	this->BuildStatusBar();
+	this->BuildMessageBar();
 	
-	this->DrawRows(terminal);
-	this->DrawStatusBar(terminal);
-	this->DrawMessageBar(terminal);
+	// If only the cursor was moved, then the frame is the cursor move and the changed cells of the status bar.
+	bool contentChanged = damaged || m_MessageBarLine != m_DrawnMessageBar;
+	bool statusChanged = m_StatusBarText != m_DrawnStatusBar;
+	if (contentChanged || statusChanged)
+	{
+		terminal.HideCursor();
+	}
 	
-	terminal->SetCursorPosition({ m_Rx - m_Offset.x, m_Cursor.y - m_Offset.y });
-	terminal->ShowCursor();
+	if (contentChanged)
+	{
+		terminal.SetBackgroundColor(m_BackgroundColor);
+		terminal.SetForegroundColor(m_ForegroundColor);
+
+		// Only the damaged rows of the views are drawn again.
+		for (BufferView* view = this->GetRootView(); view != nullptr; view = view->GetChild())
+		{
+			this->DrawView(*view, terminal);
+			view->ClearDamage();
+		}
+		
+		this->DrawChangedCells(m_MessageBarLine, m_DrawnMessageBar, m_TerminalSize.y - 1, terminal);
+	}
 
-	terminal->RevertAllAttributes();
+	if (statusChanged)
+	{
+		terminal.SetBackgroundColor(m_BackgroundColor.Inverted());
+		terminal.SetForegroundColor(m_ForegroundColor.Inverted());
+		this->DrawChangedCells(m_StatusBarText, m_DrawnStatusBar, m_TerminalSize.y - 2, terminal);
+	}
+
+	TerminalCoord position = m_ActiveView->GetPosition();
+	TerminalCoord cursor = m_ActiveView->GetCursorOnScreen();
+	terminal.SetCursorPosition({ position.x + cursor.x, position.y + cursor.y });
+	
+	if (contentChanged || statusChanged)
+	{
+		terminal.ShowCursor();
+		terminal.RevertAllAttributes();
+	}
 	
-	terminal->Flush();
+	terminal.Flush();
 
 	m_MessageBarTextLifeTime--;
 	if (m_MessageBarTextLifeTime <= 0)
@@ -66,202 +122,510 @@ void Editor::RefreshScreen(std::shared_ptr<Terminal> terminal)
 	}
 }
 
-void Editor::Scroll()
+void Editor::LayoutViews()
+{
+	int height = m_TerminalSize.y - 2;
+	this->GetRootView()->Layout({ 0, 0 }, { m_TerminalSize.x, height < 0 ? 0 : height });
+}
+
+void Editor::InvalidateViews()
+{
+	for (BufferView* view = this->GetRootView(); view != nullptr; view = view->GetChild())
+	{
+		view->Invalidate();
+	}
+}
+
+void Editor::SplitView(SplitType type)
 {
-	// TODO: Make two modes: 1-line scrolling and page scrolling.
+	m_ActiveView = m_ActiveView->Split(type);
+	this->LayoutViews();
+}
 
-	if (m_Cursor.y < m_Buffer.size())
+void Editor::CloseView()
+{
+	std::unique_ptr<BufferView>& rootView = m_Buffers[m_ActiveBuffer].rootView;
+	if (rootView->GetChild() == nullptr)
 	{
-		this->ConvertCxToRx();
+		this->ShowMessage("The last view can not be closed.", 1);
+		return;
 	}
-	else
+
+	if (m_ActiveView == rootView.get())
 	{
-		m_Rx = 0;
+		rootView = rootView->ReleaseChild();
+		m_ActiveView = rootView.get();
 	}
-	
-	if (m_Cursor.y < m_Offset.y)
+	else
 	{
-		m_Offset.y = m_Cursor.y;
+		BufferView* parent = rootView.get();
+		while (parent->GetChild() != m_ActiveView)
+		{
+			parent = parent->GetChild();
+		}
+
+		parent->CloseChild();
+		m_ActiveView = parent->GetChild() != nullptr ? parent->GetChild() : parent;
 	}
 
-	if (m_Cursor.y >= m_Offset.y + m_BufferArea.y)
+	this->LayoutViews();
+}
+
+void Editor::NextView()
+{
+	m_ActiveView = m_ActiveView->GetChild() != nullptr ? m_ActiveView->GetChild() : this->GetRootView();
+}
+
+void Editor::ToggleWrap()
+{
+	bool wrapped = !m_ActiveView->IsWrapped();
+	for (OpenBuffer& open : m_Buffers)
 	{
-		m_Offset.y = m_Cursor.y - m_BufferArea.y + 1;
+		for (BufferView* view = open.rootView.get(); view != nullptr; view = view->GetChild())
+		{
+			view->SetWrapped(wrapped);
+		}
 	}
 
-	if (m_Rx < m_Offset.x)
+	this->ShowMessage(wrapped ? "The long lines are wrapped." : "The long lines are not wrapped.", 1);
+}
+
+void Editor::SwitchBuffer(size_t index)
+{
+	if (index == m_ActiveBuffer)
 	{
-		m_Offset.x = m_Rx;
+		return;
 	}
 
-	if (m_Rx >= m_Offset.x + m_BufferArea.x)
+	OpenBuffer& target = m_Buffers[index];
+	target.buffer->Load();
+
+	// The matches are found in the rows of the old buffer.
+	this->ClearSearch();
+	
+	m_Buffer->RemoveListener(this);
+	m_Buffers[m_ActiveBuffer].activeView = m_ActiveView;
+	m_Buffers[m_ActiveBuffer].lastUsed = ++m_SwitchCount;
+
+	m_ActiveBuffer = index;
+	m_Buffer = target.buffer;
+	m_ActiveView = target.activeView;
+	m_Buffer->AddListener(this);
+
+	// The views of the buffer could be laid out for another terminal size.
+	this->LayoutViews();
+	this->EvictBuffers();
+
+	// If the buffer was unloaded, then the file could be changed meanwhile.
+	for (BufferView* view = this->GetRootView(); view != nullptr; view = view->GetChild())
 	{
-		m_Offset.x = m_Rx - m_BufferArea.x + 1;
+		view->ClampToBuffer();
 	}
+
+	this->ShowMessage("Buffer " + std::to_string(index + 1) + "/" + std::to_string(m_Buffers.size()) + ": '" + m_Buffer->GetFileName() + "'" + (m_Buffer->IsNewFile() ? " (new file)." : "."), 1);
 }
 
-void Editor::ConvertCxToRx()
+void Editor::EvictBuffers()
 {
-	const Row& row = m_Buffer[m_Cursor.y];
-	
-	m_Rx = 0;
-	for (int i = 0; i < m_Cursor.x; i++)
+	size_t usage = 0;
+	for (const OpenBuffer& open : m_Buffers)
 	{
-		if (row.real[i] == '\t')
+		if (open.buffer->IsLoaded())
 		{
-			// **** TabStop
-			// **   (rx % ts)
-			//   ** ts - (rx % ts)
-			m_Rx += m_TabStop - (m_Rx % m_TabStop);
+			usage += open.buffer->GetMemoryUsage();
 		}
-		else
+	}
+
+	while (usage > m_MemoryBudget)
+	{
+		// The buffers with unsaved changes can not be read again, so they are never unloaded.
+		OpenBuffer* victim = nullptr;
+		for (size_t i = 0; i < m_Buffers.size(); i++)
+		{
+			OpenBuffer& open = m_Buffers[i];
+			if (i != m_ActiveBuffer && open.buffer->IsLoaded() && !open.buffer->IsDirty() && (victim == nullptr || open.lastUsed < victim->lastUsed))
+			{
+				victim = &open;
+			}
+		}
+
+		if (victim == nullptr)
 		{
-			m_Rx++;
+			break;
 		}
+
+		usage -= victim->buffer->GetMemoryUsage();
+		victim->buffer->Unload();
 	}
 }
 
-void Editor::DrawRows(std::shared_ptr<Terminal> terminal)
+template <typename TerminalType>
+void Editor::DrawView(BufferView& view, TerminalType& terminal)
 {
-	for (int y = 0; y < m_BufferArea.y; y++)
+	TerminalCoord position = view.GetPosition();
+	TerminalCoord size = view.GetSize();
+	
+	// The view that reaches the right edge of the terminal clears the rest of its rows faster.
+	bool lastColumn = position.x + size.x >= m_TerminalSize.x;
+
+	for (int y = 0; y < size.y; y++)
 	{
-		int fileRow = y + m_Offset.y;
+		if (!view.IsRowDamaged(y))
+		{
+			continue;
+		}
+
+		terminal.SetCursorPosition({ position.x, position.y + y });
+		int written = this->DrawViewRow(view, y, terminal);
 		
-		if (fileRow >= m_Buffer.size())
+		// A full row is not cleared: after the last column the cursor stays on it, so the last character would be erased.
+		if (written >= size.x)
+		{
+			continue;
+		}
+		if (lastColumn)
 		{
-			this->DrawDefaultRow(y, terminal);
+			terminal.ClearCurrentRow();
 		}
 		else
 		{
-			// TODO: Two modes: the exceeding part of the line is not shown or it is printed on next line.
-			const std::vector<char>& line = m_Buffer[fileRow].render;
-			
-			int sizeToPrint = line.size() - m_Offset.x;
+			this->WriteRepeated(' ', size.x - written, terminal);
+		}
+	}
 
-			if (sizeToPrint < 0)
-			{
-				sizeToPrint = 0;
-			}
-			
-			if (sizeToPrint > m_BufferArea.x)
+	if (view.GetChild() == nullptr || !view.IsSeparatorDamaged())
+	{
+		return;
+	}
+
+	terminal.SetBackgroundColor(m_BackgroundColor.Inverted());
+	terminal.SetForegroundColor(m_ForegroundColor.Inverted());
+	
+	if (view.GetSplitType() == SplitType::HORIZONTAL)
+	{
+		terminal.SetCursorPosition({ position.x, position.y + size.y });
+		this->WriteRepeated('-', size.x, terminal);
+	}
+	else
+	{
+		for (int y = 0; y < size.y; y++)
+		{
+			terminal.SetCursorPosition({ position.x + size.x, position.y + y });
+			terminal.WriteCharacter('|');
+		}
+	}
+	
+	terminal.SetBackgroundColor(m_BackgroundColor);
+	terminal.SetForegroundColor(m_ForegroundColor);
+}
+
+template <typename TerminalType>
+int Editor::DrawViewRow(BufferView& view, int y, TerminalType& terminal)
+{
+	// The screen row shows the row from the render X coordinate: the horizontal offset or the start of a wrapped line.
+	TerminalCoord rowStart = view.GetRowStart(y);
+	int fileRow = rowStart.y;
+		
+	if (fileRow >= m_Buffer->GetRowCount())
+	{
+		return this->DrawDefaultRow(view, y, terminal);
+	}
+
+	const Buffer::Row& row = m_Buffer->GetRow(fileRow);
+	// Only the shown part of the row is expanded, so a long row costs as much as a short one.
+	RenderChars line = m_Buffer->GetRenderRange(row, rowStart.x, rowStart.x + view.GetSize().x, m_RenderScratch);
+	int sizeToPrint = line.size;
+
+	int start = rowStart.x;
+	int end = rowStart.x + sizeToPrint;
+
+	const std::vector<LineMatch>* matches = sizeToPrint != 0 ? this->GetRowMatches(fileRow) : nullptr;
+	if (matches != nullptr)
+	{
+		// The matches that end before the shown part are skipped without converting their bounds.
+		int startCx = m_Buffer->RowRxToCx(row, start);
+		auto match = std::partition_point(matches->begin(), matches->end(), [startCx](const LineMatch& match)
+		{
+			return static_cast<int>(match.start + match.length) <= startCx;
+		});
+
+		// The matches are found in the real line, so their bounds are converted to the render coordinates.
+		int cx = 0;
+		int rx = 0;
+		for (; match != matches->end(); ++match)
+		{
+			int matchStart = m_Buffer->RowCxToRx(row, match->start, cx, rx);
+			int matchEnd = m_Buffer->RowCxToRx(row, match->start + match->length, match->start, matchStart);
+			cx = match->start + match->length;
+			rx = matchEnd;
+
+			if (matchStart >= end)
 			{
-				sizeToPrint = m_BufferArea.x;
+				break;
 			}
-
-			if (sizeToPrint != 0)
+					
+			if (matchEnd > start)
 			{
-				std::vector<char> subvec = std::vector<char>(line.begin() + m_Offset.x, line.begin() + m_Offset.x + sizeToPrint);
+				if (matchStart > start)
+				{
+					this->DrawRenderRange(row, line, rowStart.x, start, matchStart, terminal);
+					start = matchStart;
+				}
 
-				
-				terminal->WriteCharVector(line, m_Offset.x, sizeToPrint);
+				int highlightEnd = matchEnd < end ? matchEnd : end;
+				terminal.SetBackgroundColor(m_MatchBackgroundColor);
+				terminal.SetForegroundColor(m_MatchForegroundColor);
+				terminal.WriteChars(line.data + start - rowStart.x, highlightEnd - start);
+				terminal.SetBackgroundColor(m_BackgroundColor);
+				terminal.SetForegroundColor(m_ForegroundColor);
+				start = highlightEnd;
 			}
 		}
+	}
 
-		terminal->ClearCurrentRow();
-		terminal->WriteString("\r\n");
+	if (start < end)
+	{
+		this->DrawRenderRange(row, line, rowStart.x, start, end, terminal);
 	}
+
+	return sizeToPrint;
 }
 
-void Editor::DrawDefaultRow(int y, std::shared_ptr<Terminal> terminal)
+template <typename TerminalType>
+void Editor::DrawRenderRange(const Buffer::Row& row, RenderChars render, int renderStart, int from, int to, TerminalType& terminal)
 {
-	// TODO: Delete the welcome message.
-	if (y == m_BufferArea.y / 3 && m_Buffer.size() == 0)
+	if (m_Buffer->GetSyntax() == nullptr || row.highlightState == HighlightState::UNKNOWN)
+	{
+		terminal.WriteChars(render.data + from - renderStart, to - from);
+		return;
+	}
+
+	// The first span which ends after from.
+	auto span = std::upper_bound(row.highlight.begin(), row.highlight.end(), from, [](int x, const HighlightSpan& span)
+	{
+		return x < static_cast<int>(span.start + span.length);
+	});
+
+	// The color is changed once per span, and back once per gap between the spans.
+	bool colored = false;
+	while (from < to)
 	{
-		if (m_BufferArea.x > sizeof(WELCOME_MESSAGE))
+		int spanStart = span != row.highlight.end() && static_cast<int>(span->start) < to ? span->start : to;
+		if (from < spanStart)
 		{
-			// TODO: Position the welcome string more pretty.
-			int padding = (m_BufferArea.x - sizeof(WELCOME_MESSAGE)) / 2;
-			if (padding != 0)
+			if (colored)
 			{
-				terminal->WriteString("~");
-				padding--;
+				terminal.SetForegroundColor(m_ForegroundColor);
+				colored = false;
 			}
-
-			terminal->WriteString(std::string(padding, ' '));
-				
-			terminal->WriteString(WELCOME_MESSAGE);
+			
+			terminal.WriteChars(render.data + from - renderStart, spanStart - from);
+			from = spanStart;
+			continue;
 		}
-		else
+
+		int spanEnd = span->start + span->length < to ? span->start + span->length : to;
+		terminal.SetForegroundColor(GetHighlightColor(span->style));
+		terminal.WriteChars(render.data + from - renderStart, spanEnd - from);
+		colored = true;
+		from = spanEnd;
+		span++;
+	}
+
+	if (colored)
+	{
+		terminal.SetForegroundColor(m_ForegroundColor);
+	}
+}
+
+template <typename TerminalType>
+int Editor::DrawDefaultRow(BufferView& view, int y, TerminalType& terminal)
+{
+	TerminalCoord size = view.GetSize();
+	
+	// TODO: Delete the welcome message.
+	if (y == size.y / 3 && m_Buffer->GetRowCount() == 0 && size.x > sizeof(WELCOME_MESSAGE))
+	{
+		// TODO: Position the welcome string more pretty.
+		int padding = (size.x - sizeof(WELCOME_MESSAGE)) / 2;
+		int written = padding + sizeof(WELCOME_MESSAGE) - 1;
+		if (padding != 0)
 		{
-			terminal->WriteString("~");
+			terminal.WriteCharacter('~');
+			padding--;
 		}
+
+		this->WriteRepeated(' ', padding, terminal);
+				
+		terminal.WriteChars(WELCOME_MESSAGE, sizeof(WELCOME_MESSAGE) - 1);
+		return written;
 	}
-	else
+
+	if (size.x == 0)
 	{
-		terminal->WriteString("~");		
+		return 0;
 	}
+	
+	terminal.WriteCharacter('~');
+	return 1;
+}
+
+template <typename TerminalType>
+void Editor::WriteRepeated(char ch, int count, TerminalType& terminal)
+{
+	// The string keeps its capacity, so it is allocated only when the terminal becomes wider.
+	m_RepeatedChars.assign(count, ch);
+	terminal.WriteString(m_RepeatedChars);
 }
 
-void Editor::DrawStatusBar(std::shared_ptr<Terminal> terminal)
+/// Append the decimal digits of the number to the string, padded with spaces to the width.
+static void AppendNumber(std::string& str, size_t number, int width = 0)
 {
-	terminal->SetBackgroundColor(m_BackgroundColor.Inverted());
-	terminal->SetForegroundColor(m_ForegroundColor.Inverted());
+	char digits[24];
+	char* end = std::to_chars(digits, digits + sizeof(digits), number).ptr;
+	for (int i = end - digits; i < width; i++)
+	{
+		str += ' ';
+	}
+	str.append(digits, end);
+}
 
+void Editor::BuildStatusBar()
+{
 	// Style: name, percent, line, character.
 	// " - name - percent - LN - CN - modified ------- "
-	std::stringstream ss;
-	ss << " - " << m_FileName << " - ";
-	ss << std::setw(3);
-	if (m_Buffer.size() == 0)
+	TerminalCoord cursor = m_ActiveView->GetCursor();
+	int rowCount = m_Buffer->GetRowCount();
+	
+	// The text is built in a member, so it is not allocated on every frame.
+	std::string& status = m_StatusBarText;
+	status.clear();
+	status += " - ";
+	status += m_Buffer->GetFileName();
+	status += " - ";
+	if (m_Buffers.size() > 1)
+	{
+		AppendNumber(status, m_ActiveBuffer + 1);
+		status += '/';
+		AppendNumber(status, m_Buffers.size());
+		status += " - ";
+	}
+	if (rowCount == 0)
 	{
-		ss << 0;
+		AppendNumber(status, 0, 3);
 	}
-	else if (m_Cursor.y == m_Buffer.size())
+	else if (cursor.y == rowCount)
 	{
-		ss << 100;
+		AppendNumber(status, 100, 3);
 	}
 	else
 	{
-		int percent = (m_Cursor.y + 1) / static_cast<float>(m_Buffer.size()) * 100;
-		ss << percent;
+		int percent = (cursor.y + 1) / static_cast<float>(rowCount) * 100;
+		AppendNumber(status, percent, 3);
 	}
-	ss << '%';
-	ss << " - L" << (m_Cursor.y + 1) << " - C" << (m_Cursor.x + 1) << " -";
-	ss << " " << (m_FileDirty ? "**" : "  ") << " -";
-	std::string statusStr = ss.str();
-
-	if (statusStr.size() <= m_TerminalSize.x)
+	status += '%';
+	status += " - L";
+	AppendNumber(status, cursor.y + 1);
+	status += " - C";
+	AppendNumber(status, cursor.x + 1);
+	status += " -";
+	status += m_Buffer->IsDirty() ? " ** -" : "    -";
+	if (m_Buffer->GetSyntax() != nullptr)
 	{
-		terminal->WriteString(statusStr);
+		status += ' ';
+		status += m_Buffer->GetSyntax()->name;
+		status += " -";
+	}
+	if (m_MacroRecording)
+	{
+		status += " REC -";
+	}
 
-		for (int i = statusStr.size(); i < m_TerminalSize.x; i++)
+	if (status.size() <= m_TerminalSize.x)
+	{
+		for (int i = status.size(); i < m_TerminalSize.x; i++)
 		{
-			terminal->WriteCharacter(i == (m_TerminalSize.x - 1) ? ' ' : '-');
+			status += i == (m_TerminalSize.x - 1) ? ' ' : '-';
 		}
 	}
 	else
 	{
-		terminal->WriteString(std::string(m_TerminalSize.x, ' '));
+		status.assign(m_TerminalSize.x, ' ');
 	}
-	
-	terminal->SetBackgroundColor(m_BackgroundColor);
-	terminal->SetForegroundColor(m_ForegroundColor);
-
-	terminal->WriteString("\r\n");
 }
 
-void Editor::DrawMessageBar(std::shared_ptr<Terminal> terminal)
+void Editor::BuildMessageBar()
 {
-	if (m_MessageBarText.size() >= m_TerminalSize.x)
+	std::string& line = m_MessageBarLine;
+	if (m_PromptAction != PromptAction::NONE)
 	{
-		terminal->WriteString(m_MessageBarText.substr(0, m_TerminalSize.x - 1 - 3));
-		terminal->WriteString("...");
+		line.assign(m_PromptLabel);
+		line += m_PromptInput;
 	}
 	else
 	{
-		terminal->WriteString(m_MessageBarText);
-		terminal->WriteString(std::string(m_TerminalSize.x - m_MessageBarText.size(), ' '));
+		line.assign(m_MessageBarText);
+	}
+	
+	// The line always fills the width, so it overwrites the longer text of the previous frame.
+	if (line.size() >= m_TerminalSize.x)
+	{
+		size_t shown = m_TerminalSize.x > 4 ? m_TerminalSize.x - 1 - 3 : 0;
+		line.resize(shown);
+		line += "...";
+	}
+	line.resize(m_TerminalSize.x, ' ');
+}
+
+template <typename TerminalType>
+void Editor::DrawChangedCells(const std::string& line, std::string& drawn, int y, TerminalType& terminal)
+{
+	size_t first = 0;
+	size_t last = line.size();
+	if (line.size() == drawn.size())
+	{
+		while (first < last && line[first] == drawn[first])
+		{
+			first++;
+		}
+		while (last > first && line[last - 1] == drawn[last - 1])
+		{
+			last--;
+		}
+	}
+
+	if (first < last)
+	{
+		terminal.SetCursorPosition({ static_cast<int>(first), y });
+		terminal.WriteString(line, first, last - first);
 	}
+
+	// The copy keeps the capacity of drawn, so it does not allocate.
+	drawn.assign(line);
 }
 
 bool Editor::ProcessKey(TerminalKey key)
 {
+	// The keys that control the macro itself are never recorded, so the replay can not recurse.
+	bool isMacroControlKey = key.IsCtrl() && (key.GetChar() == 'r' || key.GetChar() == 'e' || key.GetChar() == 'q');
+	if (m_MacroRecording && !m_MacroReplaying && !isMacroControlKey)
+	{
+		m_Macro.push_back(key);
+	}
+
+	if (m_PromptAction != PromptAction::NONE)
+	{
+		this->ProcessPromptKey(key);
+		return true;
+	}
+	
 	switch (key.GetChar())
 	{
 	case 'q':
 		if (key.IsCtrl())
 		{
-			if (m_FileDirty && m_ExitConfirmations > 0)
+			bool dirty = std::any_of(m_Buffers.begin(), m_Buffers.end(), [](const OpenBuffer& open) { return open.buffer->IsDirty(); });
+			if (dirty && m_ExitConfirmations > 0)
 			{
 				// TODO: Unsafe exit confirmation integer to string.
 				this->ShowMessage("WARNING: File has unsaved changes. Press Ctrl-Q " + std::to_string(m_ExitConfirmations) + " more to really exit.", 1);
@@ -275,18 +639,18 @@ bool Editor::ProcessKey(TerminalKey key)
 		}
 		else
 		{
-			this->InsertChar(key.GetChar());
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
 
 	case 'm':
 		if (key.IsCtrl())
 		{
-			this->InsertNewLine();
+			m_ActiveView->InsertNewLine();
 		}
 		else
 		{
-			this->InsertChar(key.GetChar());
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
 
@@ -297,323 +661,746 @@ bool Editor::ProcessKey(TerminalKey key)
 		}
 		else
 		{
-			this->InsertChar(key.GetChar());
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
 		
-	case TerminalKeys::DELETE:
-	case TerminalKeys::BACKSPACE:
-		if (key.GetChar() == TerminalKeys::DELETE)
+	case 'f':
+		if (key.IsCtrl())
 		{
-			ProcessMoveCursor(TerminalKey(TerminalKeys::ARROW_RIGHT, false, false));
+			this->ClearSearch();
+			m_SearchOrigin = m_ActiveView->GetCursor();
+			m_SearchOriginOffset = m_ActiveView->GetOffset();
+			this->StartPrompt("Search (ESC - cancel, arrows - next/previous): ", PromptAction::SEARCH);
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
 		}
-		this->DeleteChar();
-		break;
-
-	case TerminalKeys::ESCAPE:
-		break;
-		
-	case TerminalKeys::ARROW_UP:
-	case TerminalKeys::ARROW_DOWN:
-	case TerminalKeys::ARROW_LEFT:
-	case TerminalKeys::ARROW_RIGHT:
-		this->ProcessMoveCursor(key);
 		break;
 
-	case TerminalKeys::PAGE_UP:
-	case TerminalKeys::PAGE_DOWN:
-	{
-		if (key.GetChar() == TerminalKeys::PAGE_UP)
+	case 'g':
+		if (key.IsCtrl())
 		{
-			m_Cursor.y = m_Offset.y;
+			this->ClearSearch();
+			m_SearchOrigin = m_ActiveView->GetCursor();
+			m_SearchOriginOffset = m_ActiveView->GetOffset();
+			this->StartPrompt("Regex search (ESC - cancel, arrows - next/previous): ", PromptAction::REGEX_SEARCH);
 		}
-		else if (key.GetChar() == TerminalKeys::PAGE_DOWN)
+		else
 		{
-			m_Cursor.y = m_Offset.y + m_BufferArea.y - 1;
-			if (m_Cursor.y > m_Buffer.size())
-			{
-				m_Cursor.y = m_Buffer.size();
-			}
+			m_ActiveView->InsertChar(key.GetChar());
 		}
-		
-		int times = m_BufferArea.y;
-		while (times--)
+		break;
+
+	case 'n':
+	case 'p':
+		if (key.IsCtrl())
 		{
-			if (key.GetChar() == TerminalKeys::PAGE_UP)
+			if (!m_MatchIndexActive)
 			{
-				this->ProcessMoveCursor(TerminalKey(TerminalKeys::ARROW_UP, false, false));
+				this->ShowMessage("There is no search.", 1);
 			}
-			else if (key.GetChar() == TerminalKeys::PAGE_DOWN)
+			else if (!this->JumpToMatch(key.GetChar() == 'n'))
 			{
-				this->ProcessMoveCursor(TerminalKey(TerminalKeys::ARROW_DOWN, false, false));
+				this->ShowMessage("No matches.", 1);
 			}
 		}
-		break;
-	}
-	
-	case TerminalKeys::HOME:
-		m_Cursor.x = 0;
-		break;
-		
-	case TerminalKeys::END:
-		if (m_Cursor.y < m_Buffer.size())
+		else
 		{
-			m_Cursor.x = m_Buffer[m_Cursor.y].real.size();
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
-		
-	default:
-		if (key.IsCtrl() || key.IsAlt())
+
+	case 't':
+		if (key.IsCtrl())
 		{
-			// TODO: Show the key press text representation in wrong key press.
-			this->ShowMessage("Unbound key press: ", 1);
+			this->StartPrompt("Replace: ", PromptAction::REPLACE_FIND);
 		}
 		else
 		{
-			this->InsertChar(key.GetChar());
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
-	}
-
-	m_ExitConfirmations = 3;
-	return true;
-}
 
-void Editor::ProcessMoveCursor(TerminalKey key)
-{
-	// TODO: 2 modes: free move and only line move.
-	// TODO: Word jump.
-	// TODO: Save last cursor pos, if entered a small line.
-	
-	const std::vector<char>* line = (m_Cursor.y >= m_Buffer.size() ? nullptr : &m_Buffer[m_Cursor.y].real);
-	
-	switch (key.GetChar())
-	{
-	case TerminalKeys::ARROW_UP:
-	case 'w':
-		if (m_Cursor.y != 0)
+	case 'z':
+		if (key.IsCtrl())
 		{
-			m_Cursor.y--;	
+			if (!m_ActiveView->Undo())
+			{
+				this->ShowMessage("Nothing to undo.", 1);
+			}
 		}
-		break;
-	case TerminalKeys::ARROW_LEFT:
-	case 'a':
-		if (m_Cursor.x != 0)
+		else
 		{
-			m_Cursor.x--;	
+			m_ActiveView->InsertChar(key.GetChar());
 		}
-		else if (m_Cursor.y > 0)
+		break;
+
+	case 'r':
+		if (key.IsCtrl())
 		{
-			m_Cursor.y--;
-			m_Cursor.x = m_Buffer[m_Cursor.y].real.size();
+			this->ToggleMacroRecording();
 		}
-		break;
-	case TerminalKeys::ARROW_DOWN:
-	case 's':
-		if (m_Cursor.y < m_Buffer.size())
+		else
 		{
-			m_Cursor.y++;	
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
-	case TerminalKeys::ARROW_RIGHT:
-	case 'd':
-		if (line != nullptr && m_Cursor.x < line->size())
+
+	case 'e':
+		if (key.IsCtrl())
+		{
+			if (m_MacroRecording)
+			{
+				this->ShowMessage("Stop the macro recording before replaying it.", 1);
+			}
+			else
+			{
+				this->StartPrompt("Replay the macro times (empty - until the end of the buffer): ", PromptAction::MACRO_REPLAY);
+			}
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
+		}
+		break;
+		
+	case 'o':
+	case 'v':
+		if (key.IsCtrl())
+		{
+			this->SplitView(key.GetChar() == 'o' ? SplitType::HORIZONTAL : SplitType::VERTICAL);
+		}
+		else
 		{
-			m_Cursor.x++;
+			m_ActiveView->InsertChar(key.GetChar());
 		}
-		else if (line != nullptr && m_Cursor.x == line->size())
+		break;
+
+	case 'w':
+		if (key.IsCtrl())
+		{
+			this->NextView();
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
+		}
+		break;
+
+	case 'k':
+		if (key.IsCtrl())
 		{
-			m_Cursor.y++;
-			m_Cursor.x = 0;
+			this->CloseView();
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
 		}
 		break;
+
+	case 'l':
+		if (key.IsCtrl())
+		{
+			this->ToggleWrap();
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
+		}
+		break;
+
+	case 'b':
+	case 'y':
+		if (key.IsCtrl())
+		{
+			size_t count = m_Buffers.size();
+			this->SwitchBuffer(key.GetChar() == 'b' ? (m_ActiveBuffer + 1) % count : (m_ActiveBuffer + count - 1) % count);
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
+		}
+		break;
+		
+	case TerminalKeys::DELETE:
+	case TerminalKeys::BACKSPACE:
+		if (key.GetChar() == TerminalKeys::DELETE)
+		{
+			m_ActiveView->MoveCursor(TerminalKey(TerminalKeys::ARROW_RIGHT, false, false));
+		}
+		m_ActiveView->DeleteChar();
+		break;
+
+	case TerminalKeys::ESCAPE:
+		break;
+		
+	case TerminalKeys::ARROW_UP:
+	case TerminalKeys::ARROW_DOWN:
+	case TerminalKeys::ARROW_LEFT:
+	case TerminalKeys::ARROW_RIGHT:
+	case TerminalKeys::PAGE_UP:
+	case TerminalKeys::PAGE_DOWN:
+	case TerminalKeys::HOME:
+	case TerminalKeys::END:
+		m_ActiveView->MoveCursor(key);
+		break;
+		
 	default:
-		assert(false && "This should not be occured. Key argument is wrong, probably there is a mistake in switch in Editor::ProcessKey.");
+		if (key.IsCtrl() || key.IsAlt())
+		{
+			// TODO: Show the key press text representation in wrong key press.
+			this->ShowMessage("Unbound key press: ", 1);
+		}
+		else
+		{
+			m_ActiveView->InsertChar(key.GetChar());
+		}
 		break;
 	}
 
-	line = (m_Cursor.y >= m_Buffer.size() ? nullptr : &m_Buffer[m_Cursor.y].real);
-	int rowLength = line != nullptr ? line->size() : 0;
-	if (m_Cursor.x > rowLength)
+	m_ExitConfirmations = 3;
+	return true;
+}
+
+void Editor::SetTabSize(int newSize)
+{
+	for (OpenBuffer& open : m_Buffers)
 	{
-		m_Cursor.x = rowLength;
+		open.buffer->SetTabStop(newSize);
 	}
 }
 
-void Editor::SetTabSize(int newSize)
+void Editor::ShowMessage(const std::string& msg, int lifeTime)
+{
+	m_MessageBarText = msg;
+	m_MessageBarTextLifeTime = lifeTime;
+}
+
+void Editor::Save()
 {
-	if (newSize == m_TabStop)
+	m_Buffer->Save();
+	this->ShowMessage("Wrote '" + m_Buffer->GetFilePath() + "'.", 1);
+}
+
+void Editor::ReplaceAll(const std::string& query, const std::string& replacement)
+{
+	if (query.empty())
 	{
 		return;
 	}
 
-	if (newSize <= 0)
+	int changedLines = 0;
+	size_t replaced = m_Buffer->ReplaceAll(query, replacement, m_ActiveView->GetCursor(), changedLines);
+	if (replaced == 0)
 	{
-		throw std::out_of_range("new tab stop size is 0 or negative, but should be greater than 0");
+		this->ShowMessage("No occurrences of '" + query + "'.", 1);
+		return;
 	}
+	
+	this->ShowMessage("Replaced " + std::to_string(replaced) + " occurrences in " + std::to_string(changedLines) + " lines. Ctrl-Z - undo.", 1);
+}
 
-	m_TabStop = newSize;
-
-	for (Row& row : m_Buffer)
+void Editor::OnRowsChanged(int first, int count)
+{
+	for (int y = first; y < first + count; y++)
 	{
-		this->UpdateRow(row);
+		this->UpdateRowMatches(y);
 	}
 }
 
-void Editor::AppendRow(const std::string& str)
+void Editor::OnRowsRestyled(int first, int count)
 {
-	m_Buffer.push_back(Row());
+	// The views redraw the restyled rows themselves.
+}
 
-	m_Buffer.back().real = std::vector<char>(str.begin(), str.end());
-	this->UpdateRow(m_Buffer.back());
-}	
+void Editor::OnRowsShifted(int y, int count)
+{
+	if (!m_MatchIndexActive)
+	{
+		return;
+	}
 
-void Editor::UpdateRow(Row& row)
+	this->StopRegexSearch();
+	if (count > 0)
+	{
+		m_MatchIndex.InsertLines(y, count);
+	}
+	else
+	{
+		m_MatchIndex.EraseLines(y, -count);
+	}
+}
+
+void Editor::StartPrompt(const std::string& label, PromptAction action)
 {
-	row.render.clear();
-	
-	for (int i = 0; i < row.real.size(); i++)
+	m_PromptLabel = label;
+	m_PromptInput.clear();
+	m_PromptAction = action;
+	this->OnPromptInputChanged();
+}
+
+void Editor::ProcessPromptKey(TerminalKey key)
+{
+	if (key.GetChar() == TerminalKeys::ESCAPE)
 	{
-		if (row.real[i] == '\t') {
-            
-			row.render.push_back(' ');
-			while (row.render.size() % m_TabStop != 0)
-			{
-				row.render.push_back(' ');
-			}
+		this->CancelPrompt();
+	}
+	else if (key.GetChar() == 'm' && key.IsCtrl())
+	{
+		this->FinishPrompt();
+	}
+	else if (key.GetChar() == TerminalKeys::BACKSPACE || key.GetChar() == TerminalKeys::DELETE)
+	{
+		if (!m_PromptInput.empty())
+		{
+			m_PromptInput.pop_back();
+			this->OnPromptInputChanged();
 		}
-		else
+	}
+	else if (m_PromptAction == PromptAction::SEARCH
+			 && (key.GetChar() == TerminalKeys::ARROW_DOWN || key.GetChar() == TerminalKeys::ARROW_RIGHT))
+	{
+		if (!this->SearchFrom({ m_ActiveView->GetCursor().x + 1, m_ActiveView->GetCursor().y }, true))
+		{
+			this->ShowMessage("No matches.", 1);
+		}
+	}
+	else if (m_PromptAction == PromptAction::SEARCH
+			 && (key.GetChar() == TerminalKeys::ARROW_UP || key.GetChar() == TerminalKeys::ARROW_LEFT))
+	{
+		if (!this->SearchFrom(m_ActiveView->GetCursor(), false))
+		{
+			this->ShowMessage("No matches.", 1);
+		}
+	}
+	else if (m_PromptAction == PromptAction::REGEX_SEARCH
+			 && (key.GetChar() == TerminalKeys::ARROW_DOWN || key.GetChar() == TerminalKeys::ARROW_RIGHT
+				 || key.GetChar() == TerminalKeys::ARROW_UP || key.GetChar() == TerminalKeys::ARROW_LEFT))
+	{
+		bool forward = key.GetChar() == TerminalKeys::ARROW_DOWN || key.GetChar() == TerminalKeys::ARROW_RIGHT;
+		if (!this->JumpToMatch(forward))
 		{
-			row.render.push_back(row.real[i]);
+			this->ShowMessage("No matches.", 1);
 		}
 	}
+	else if (!key.IsCtrl() && !key.IsAlt() && key.GetChar() < TerminalKeys::ARROW_LEFT)
+	{
+		m_PromptInput.push_back(key.GetChar());
+		this->OnPromptInputChanged();
+	}
 }
 
-void Editor::RowInsertChar(Row& row, int at, char ch)
+void Editor::CancelPrompt()
 {
-	if (at < 0)
+	// The snapshot serves only the queries of one prompt, the buffer may change after it.
+	m_RegexSnapshot = nullptr;
+	if (m_PromptAction == PromptAction::SEARCH || m_PromptAction == PromptAction::REGEX_SEARCH)
 	{
-		at = 0;
+		this->ClearSearch();
+		m_ActiveView->SetCursor(m_SearchOrigin);
+		m_ActiveView->SetOffset(m_SearchOriginOffset);
 	}
+	
+	m_PromptAction = PromptAction::NONE;
+}
 
-	if (at > row.real.size())
+void Editor::OnPromptInputChanged()
+{
+	if (m_PromptAction == PromptAction::SEARCH)
 	{
-		at = row.real.size();
+		// Every new character restarts the search from the original position, so the current match grows with the query.
+		m_SearchQuery = m_PromptInput;
+		if (m_SearchQuery.empty() || !this->SearchFrom(m_SearchOrigin, true))
+		{
+			m_ActiveView->SetCursor(m_SearchOrigin);
+		}
+		this->InvalidateViews();
 	}
+	else if (m_PromptAction == PromptAction::REGEX_SEARCH)
+	{
+		m_ActiveView->SetCursor(m_SearchOrigin);
+		this->StartRegexSearch();
+	}
+}
+
+void Editor::FindRowMatches(const Buffer::Row& row)
+{
+	m_RowMatches.clear();
 	
-	row.real.insert(row.real.begin() + at, ch);
+	if (m_SearchRegex != nullptr)
+	{
+		m_RegexMatcher->FindAll(row.real.data(), row.real.size(), m_RowMatches);
+		return;
+	}
 
-	this->UpdateRow(row);
+	long match = FindSubstring(row.real.data(), row.real.size(), m_SearchQuery.data(), m_SearchQuery.size(), 0);
+	while (match != -1)
+	{
+		m_RowMatches.push_back({ static_cast<int>(match), static_cast<int>(m_SearchQuery.size()) });
+		match = FindSubstring(row.real.data(), row.real.size(), m_SearchQuery.data(), m_SearchQuery.size(), match + m_SearchQuery.size());
+	}
 }
 
-void Editor::InsertChar(char ch)
+const std::vector<LineMatch>* Editor::GetRowMatches(int y)
 {
-	if (m_Cursor.y == m_Buffer.size())
+	if (m_MatchIndexActive)
 	{
-		this->AppendRow("");
+		return m_MatchIndex.GetLineMatches(y);
+	}
+
+	if (m_SearchQuery.empty() && m_SearchRegex == nullptr)
+	{
+		return nullptr;
 	}
 	
-	this->RowInsertChar(m_Buffer[m_Cursor.y], m_Cursor.x, ch);
-	m_Cursor.x++;
-	m_FileDirty = true;
+	this->FindRowMatches(m_Buffer->GetRow(y));
+	return m_RowMatches.empty() ? nullptr : &m_RowMatches;
 }
 
-void Editor::ShowMessage(const std::string& msg, int lifeTime)
+void Editor::BuildMatchIndex()
 {
-	m_MessageBarText = msg;
-	m_MessageBarTextLifeTime = lifeTime;
+	m_MatchIndex.Clear();
+	m_MatchIndexActive = true;
+	this->InvalidateViews();
+
+	for (int y = 0; y < m_Buffer->GetRowCount(); y++)
+	{
+		this->FindRowMatches(m_Buffer->GetRow(y));
+		m_MatchIndex.SetLineMatches(y, m_RowMatches);
+	}
 }
 
-void Editor::Save()
+void Editor::UpdateRowMatches(int y)
+{
+	if (!m_MatchIndexActive)
+	{
+		return;
+	}
+
+	this->StopRegexSearch();
+	this->FindRowMatches(m_Buffer->GetRow(y));
+	m_MatchIndex.SetLineMatches(y, m_RowMatches);
+}
+
+void Editor::ClearSearch()
+{
+	this->StopRegexSearch();
+	m_SearchQuery.clear();
+	m_SearchRegex = nullptr;
+	m_MatchIndex.Clear();
+	m_MatchIndexActive = false;
+	this->InvalidateViews();
+}
+
+void Editor::StopRegexSearch()
 {
-	std::ofstream file(m_FilePath);
-	if (!file)
+	// The snapshot lines do not correspond to the buffer lines after an edit, so neither the snapshot nor the rest of the matches can be used.
+	m_RegexSnapshot = nullptr;
+	if (!m_RegexSearching)
 	{
-		throw EditorFileIOError("unable to write to the file");
+		return;
 	}
 
-	for (Row& row : m_Buffer)
+	m_RegexSearch->Cancel();
+	m_RegexSearching = false;
+	this->ShowMessage("The search was stopped, " + std::to_string(m_MatchIndex.GetMatchCount()) + " matches were found.", 1);
+}
+
+void Editor::StartRegexSearch()
+{
+	if (m_RegexSearch == nullptr)
 	{
-		// TODO: Different types of line endings to save.
-		for (char ch : row.real)
+		m_RegexSearch = std::make_unique<RegexSearch>();
+	}
+	
+	m_RegexSearch->Cancel();
+	m_RegexSearching = false;
+	m_RegexCursorFixed = false;
+	m_SearchRegex = nullptr;
+	m_MatchIndex.Clear();
+	m_MatchIndexActive = true;
+	this->InvalidateViews();
+	
+	if (m_PromptInput.empty())
+	{
+		return;
+	}
+	
+	try
+	{
+		m_SearchRegex = std::make_shared<Regex>(m_PromptInput);
+	}
+	catch (const RegexSyntaxError& e)
+	{
+		this->ShowMessage(std::string("Wrong regex: ") + e.what() + ".", 1);
+		return;
+	}
+	m_RegexMatcher = std::make_unique<RegexMatcher>(m_SearchRegex);
+
+	// The buffer can not change while the prompt is active, so one snapshot serves all queries of the prompt. It is dropped when the prompt ends.
+	if (m_RegexSnapshot == nullptr)
+	{
+		std::shared_ptr<BufferSnapshot> snapshot = std::make_shared<BufferSnapshot>();
+		
+		int rowCount = m_Buffer->GetRowCount();
+		size_t size = 0;
+		for (int y = 0; y < rowCount; y++)
 		{
-			file << ch;
+			size += m_Buffer->GetRow(y).real.size();
 		}
+		snapshot->text.reserve(size);
+		snapshot->lineStarts.reserve(rowCount + 1);
 		
-		file << "\n";
-
-		if (file.fail())
+		for (int y = 0; y < rowCount; y++)
 		{
-			throw EditorFileIOError("an error occured during the write to the file");
+			const Buffer::Chars& line = m_Buffer->GetRow(y).real;
+			snapshot->lineStarts.push_back(snapshot->text.size());
+			snapshot->text.append(line.begin(), line.end());
 		}
+		snapshot->lineStarts.push_back(snapshot->text.size());
+
+		m_RegexSnapshot = snapshot;
 	}
 
-	this->ShowMessage("Wrote '" + m_FilePath + "'.", 1);
-	m_FileDirty = false;
+	m_RegexSearch->Start(m_SearchRegex, m_RegexSnapshot, m_SearchOrigin.y);
+	m_RegexSearching = true;
 }
 
-void Editor::RowDeleteChar(Row& row, int at)
+bool Editor::JumpToMatch(bool forward)
 {
-	if (at < 0 || at > row.real.size())
+	BufferMatch match;
+	TerminalCoord cursor = m_ActiveView->GetCursor();
+	if (!m_MatchIndex.FindNearest(cursor.y, cursor.x, forward, match))
 	{
-		return;
+		return false;
 	}
+	
+	m_ActiveView->SetCursor({ match.start, match.line });
+	m_RegexCursorFixed = true;
+	return true;
+}
 
-	row.real.erase(row.real.begin() + at);
-	m_FileDirty = true;
-	this->UpdateRow(row);
+bool Editor::HasBackgroundWork() const
+{
+	return m_RegexSearching || m_Buffer->HasHighlightWork(m_ActiveView->GetOffset().y, m_ActiveView->GetSize().y);
+}
+
+void Editor::ProcessBackgroundWork()
+{
+	this->ProcessRegexWork();
+
+	// The rows of the active view are highlighted first.
+	std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(HIGHLIGHT_WORK_TIME);
+	m_Buffer->ProcessHighlightWork(deadline, m_ActiveView->GetOffset().y, m_ActiveView->GetSize().y);
 }
 
-void Editor::DeleteChar()
+void Editor::ProcessRegexWork()
 {
-	// TODO: Bug when there is no text, but only one line is left.
-	if (m_Cursor.y == m_Buffer.size()
-		|| (m_Cursor.y == 0 && m_Cursor.x == 0))
+	if (!m_RegexSearching)
 	{
 		return;
 	}
 
-	Row& row = m_Buffer[m_Cursor.y];
-	if (m_Cursor.x > 0)
+	m_StreamedMatches.clear();
+	m_RegexSearching = m_RegexSearch->TakeMatches(m_StreamedMatches);
+	m_MatchIndex.AddMatches(m_StreamedMatches);
+
+	// Until the user moves between the matches, the cursor follows the closest match after the start of the search.
+	if (!m_RegexCursorFixed)
 	{
-		this->RowDeleteChar(row, m_Cursor.x - 1);
-		m_Cursor.x--;
+		auto distance = [&](int line, int x)
+		{
+			bool wrapped = line < m_SearchOrigin.y || (line == m_SearchOrigin.y && x < m_SearchOrigin.x);
+			return std::make_tuple(wrapped, line, x);
+		};
+
+		TerminalCoord cursor = m_ActiveView->GetCursor();
+		bool moved = cursor.x != m_SearchOrigin.x || cursor.y != m_SearchOrigin.y;
+		for (const BufferMatch& match : m_StreamedMatches)
+		{
+			if (!moved || distance(match.line, match.start) < distance(cursor.y, cursor.x))
+			{
+				cursor = { match.start, match.line };
+				moved = true;
+			}
+		}
+		m_ActiveView->SetCursor(cursor);
 	}
-	else
+
+	this->InvalidateViews();
+	this->ShowMessage(std::to_string(m_MatchIndex.GetMatchCount()) + " matches" + (m_RegexSearching ? " (searching...)." : "."), 1);
+}
+
+bool Editor::SearchFrom(TerminalCoord from, bool forward)
+{
+	if (m_SearchQuery.empty() || m_Buffer->GetRowCount() == 0)
 	{
-		Row& previousRow = m_Buffer[m_Cursor.y - 1];
-		Row& currentRow  = m_Buffer[m_Cursor.y];
-		
-		m_Cursor.x = previousRow.real.size();
+		return false;
+	}
+
+	int lineCount = m_Buffer->GetRowCount();
+	if (from.y >= lineCount)
+	{
+		from = { 0, forward ? 0 : lineCount - 1 };
+		from.x = forward ? 0 : m_Buffer->GetRow(from.y).real.size();
+	}
+
+	// The line of the start position is visited twice: its part after the position first, and the part before the position after the wrap.
+	for (int i = 0; i <= lineCount; i++)
+	{
+		int y = forward ? (from.y + i) % lineCount : ((from.y - i) % lineCount + lineCount) % lineCount;
+		const Buffer::Chars& line = m_Buffer->GetRow(y).real;
+
+		long match;
+		if (forward)
+		{
+			size_t start = i == 0 ? from.x : 0;
+			match = FindSubstring(line.data(), line.size(), m_SearchQuery.data(), m_SearchQuery.size(), start);
+		}
+		else
+		{
+			size_t end = i == 0 ? from.x : line.size();
+			match = FindLastSubstring(line.data(), line.size(), m_SearchQuery.data(), m_SearchQuery.size(), end);
+		}
+
+		if (match != -1)
+		{
+			m_ActiveView->SetCursor({ static_cast<int>(match), y });
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void Editor::FinishPrompt()
+{
+	PromptAction action = m_PromptAction;
+	m_PromptAction = PromptAction::NONE;
+	// The running search keeps its own reference to the snapshot.
+	m_RegexSnapshot = nullptr;
+
+	switch (action)
+	{
+	case PromptAction::MACRO_REPLAY:
+	{
+		int times = 0;
+		if (!m_PromptInput.empty())
+		{
+			try
+			{
+				times = std::stoi(m_PromptInput);
+			}
+			catch (const std::exception& e)
+			{
+				times = -1;
+			}
+		}
+
+		if (times < 0)
+		{
+			this->ShowMessage("Wrong replay count: '" + m_PromptInput + "'.", 1);
+		}
+		else
+		{
+			this->ReplayMacro(times);
+		}
+		break;
+	}
+	
+	case PromptAction::SEARCH:
+		if (!m_SearchQuery.empty())
+		{
+			this->BuildMatchIndex();
+			this->ShowMessage(std::to_string(m_MatchIndex.GetMatchCount()) + " matches. Ctrl-N/Ctrl-P - next/previous match.", 1);
+		}
+		break;
 
-		previousRow.real.insert(previousRow.real.end(), currentRow.real.begin(), currentRow.real.end());
-		m_Buffer.erase(m_Buffer.begin() + m_Cursor.y);
-		this->UpdateRow(previousRow);
+	case PromptAction::REGEX_SEARCH:
+		// The search continues in the background, but it does not move the cursor anymore.
+		m_RegexCursorFixed = true;
+		break;
+		
+	case PromptAction::REPLACE_FIND:
+		if (!m_PromptInput.empty())
+		{
+			m_ReplaceQuery = m_PromptInput;
+			this->StartPrompt("Replace '" + m_ReplaceQuery + "' with: ", PromptAction::REPLACE_WITH);
+		}
+		break;
 
-		m_Cursor.y--;
+	case PromptAction::REPLACE_WITH:
+		this->ReplaceAll(m_ReplaceQuery, m_PromptInput);
+		break;
+		
+	case PromptAction::NONE:
+		break;
 	}
 }
 
-void Editor::InsertNewLine()
+void Editor::ToggleMacroRecording()
 {
-	if (m_Cursor.x == 0)
+	if (m_MacroRecording)
 	{
-		m_Buffer.insert(m_Buffer.begin() + m_Cursor.y, Row());
+		m_MacroRecording = false;
+		this->ShowMessage("Recorded a macro of " + std::to_string(m_Macro.size()) + " keys.", 1);
 	}
 	else
 	{
-		m_Buffer.insert(m_Buffer.begin() + m_Cursor.y + 1, Row());
+		m_Macro.clear();
+		m_MacroRecording = true;
+		this->ShowMessage("Recording a macro. Press Ctrl-R to stop.", 1);
+	}
+}
 
-		Row& currentRow = m_Buffer[m_Cursor.y];
-		Row& newRow = m_Buffer[m_Cursor.y + 1];
+void Editor::ReplayMacro(int times)
+{
+	if (m_Macro.empty())
+	{
+		this->ShowMessage("There is no recorded macro.", 1);
+		return;
+	}
 
-		newRow.real.insert(newRow.real.end(), currentRow.real.begin() + m_Cursor.x, currentRow.real.end());
-		currentRow.real.erase(currentRow.real.begin() + m_Cursor.x, currentRow.real.end());
+	m_MacroReplaying = true;
+
+	int replayed = 0;
+	try
+	{
+		while (times == 0 ? m_ActiveView->GetCursor().y < m_Buffer->GetRowCount() : replayed < times)
+		{
+			TerminalCoord before = m_ActiveView->GetCursor();
+			
+			for (TerminalKey key : m_Macro)
+			{
+				this->ProcessKey(key);
+			}
+			replayed++;
 
-		this->UpdateRow(currentRow);
-		this->UpdateRow(newRow);
+			// Replaying until the end of the buffer is only possible when the macro moves the cursor forward.
+			TerminalCoord after = m_ActiveView->GetCursor();
+			bool movedForward = after.y > before.y || (after.y == before.y && after.x > before.x);
+			if (times == 0 && !movedForward)
+			{
+				break;
+			}
+		}
 	}
-	
-	m_Cursor.y++;
-	m_Cursor.x = 0;
+	catch (...)
+	{
+		m_MacroReplaying = false;
+		throw;
+	}
+
+	m_MacroReplaying = false;
+	this->ShowMessage("Replayed the macro " + std::to_string(replayed) + " times.", 1);
 }
+
+// The drawing through the virtual interface, for any terminal.
+template void Editor::RefreshScreen<Terminal>(Terminal& terminal);
+// The drawing on the final backends, their calls are not virtual.
+template void Editor::RefreshScreen<HeadlessTerminal>(HeadlessTerminal& terminal);
+#ifdef EDITOR_COMPILE_UNIX
+template void Editor::RefreshScreen<UnixTerminal>(UnixTerminal& terminal);
+#endif
@@ -0,0 +1,230 @@
+/*
+ * Highlight.cpp - syntax highlighting of the editor rows.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Highlight.hpp>
+#include <KeywordTable.hpp>
+
+#include <ctype.h>
+#include <string.h>
+
+/// The keywords and the builtin types of C++.
+struct CppLanguage
+{
+	static constexpr HighlightStyle K = HighlightStyle::KEYWORD;
+	static constexpr HighlightStyle T = HighlightStyle::TYPE;
+
+	static constexpr auto WORDS = MakeKeywordTable<HighlightStyle>(
+	{
+		{ "alignas", K }, { "alignof", K }, { "asm", K }, { "break", K }, { "case", K }, { "catch", K },
+		{ "class", K }, { "const", K }, { "const_cast", K }, { "constexpr", K }, { "continue", K },
+		{ "decltype", K }, { "default", K }, { "delete", K }, { "do", K }, { "dynamic_cast", K }, { "else", K },
+		{ "enum", K }, { "explicit", K }, { "export", K }, { "extern", K }, { "false", K }, { "final", K },
+		{ "for", K }, { "friend", K }, { "goto", K }, { "if", K }, { "inline", K }, { "mutable", K },
+		{ "namespace", K }, { "new", K }, { "noexcept", K }, { "nullptr", K }, { "operator", K },
+		{ "override", K }, { "private", K }, { "protected", K }, { "public", K }, { "reinterpret_cast", K },
+		{ "return", K }, { "sizeof", K }, { "static", K }, { "static_assert", K }, { "static_cast", K },
+		{ "struct", K }, { "switch", K }, { "template", K }, { "this", K }, { "thread_local", K },
+		{ "throw", K }, { "true", K }, { "try", K }, { "typedef", K }, { "typeid", K }, { "typename", K },
+		{ "union", K }, { "using", K }, { "virtual", K }, { "volatile", K }, { "while", K },
+
+		{ "auto", T }, { "bool", T }, { "char", T }, { "char16_t", T }, { "char32_t", T }, { "double", T },
+		{ "float", T }, { "int", T }, { "long", T }, { "short", T }, { "signed", T }, { "size_t", T },
+		{ "unsigned", T }, { "void", T }, { "wchar_t", T },
+	});
+};
+
+template <typename Language>
+static HighlightState HighlightLanguageLine(const char* line, size_t size, HighlightState state, HighlightStyle* styles);
+
+static const HighlightSyntax g_Syntaxes[] =
+{
+	{
+		"C++",
+		{ ".c", ".h", ".cpp", ".hpp", ".cc", ".hh", ".cxx", ".hxx" },
+		HighlightLanguageLine<CppLanguage>,
+	},
+};
+
+const HighlightSyntax* FindHighlightSyntax(const std::string& fileName)
+{
+	size_t dot = fileName.rfind('.');
+	if (dot == std::string::npos)
+	{
+		return nullptr;
+	}
+
+	std::string extension = fileName.substr(dot);
+	for (const HighlightSyntax& syntax : g_Syntaxes)
+	{
+		for (const std::string& candidate : syntax.extensions)
+		{
+			if (candidate == extension)
+			{
+				return &syntax;
+			}
+		}
+	}
+
+	return nullptr;
+}
+
+/// Return true if the character may be a part of an identifier.
+static bool IsIdentifierChar(char ch)
+{
+	return isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+}
+
+HighlightState HighlightLine(const HighlightSyntax& syntax, const char* line, size_t size, HighlightState state, HighlightStyle* styles)
+{
+	return syntax.highlight(line, size, state, styles);
+}
+
+/// The lexer of a language. Language::WORDS is the KeywordTable of its keywords and types.
+template <typename Language>
+static HighlightState HighlightLanguageLine(const char* line, size_t size, HighlightState state, HighlightStyle* styles)
+{
+	size_t i = 0;
+
+	// Only the spaces may be before the preprocessor directive.
+	bool lineStart = true;
+	
+	while (i < size)
+	{
+		if (state == HighlightState::BLOCK_COMMENT)
+		{
+			while (i < size)
+			{
+				if (line[i] == '*' && i + 1 < size && line[i + 1] == '/')
+				{
+					styles[i++] = HighlightStyle::COMMENT;
+					styles[i++] = HighlightStyle::COMMENT;
+					state = HighlightState::NORMAL;
+					break;
+				}
+				styles[i++] = HighlightStyle::COMMENT;
+			}
+			continue;
+		}
+
+		char ch = line[i];
+
+		if (ch == '/' && i + 1 < size && line[i + 1] == '/')
+		{
+			for (; i < size; i++)
+			{
+				styles[i] = HighlightStyle::COMMENT;
+			}
+		}
+		else if (ch == '/' && i + 1 < size && line[i + 1] == '*')
+		{
+			styles[i++] = HighlightStyle::COMMENT;
+			styles[i++] = HighlightStyle::COMMENT;
+			state = HighlightState::BLOCK_COMMENT;
+		}
+		else if (ch == '#' && lineStart)
+		{
+			for (; i < size && !(line[i] == '/' && i + 1 < size && (line[i + 1] == '/' || line[i + 1] == '*')); i++)
+			{
+				styles[i] = HighlightStyle::PREPROCESSOR;
+			}
+		}
+		else if (ch == '"' || ch == '\'')
+		{
+			styles[i++] = HighlightStyle::STRING;
+			while (i < size)
+			{
+				if (line[i] == '\\' && i + 1 < size)
+				{
+					styles[i++] = HighlightStyle::STRING;
+				}
+				else if (line[i] == ch)
+				{
+					styles[i++] = HighlightStyle::STRING;
+					break;
+				}
+				styles[i++] = HighlightStyle::STRING;
+			}
+		}
+		else if (isdigit(static_cast<unsigned char>(ch)))
+		{
+			for (; i < size && (IsIdentifierChar(line[i]) || line[i] == '.' || line[i] == '\''); i++)
+			{
+				styles[i] = HighlightStyle::NUMBER;
+			}
+		}
+		else if (IsIdentifierChar(ch))
+		{
+			size_t start = i;
+			while (i < size && IsIdentifierChar(line[i]))
+			{
+				i++;
+			}
+
+			HighlightStyle style = Language::WORDS.Find(line + start, i - start, HighlightStyle::NORMAL);
+
+			for (size_t j = start; j < i; j++)
+			{
+				styles[j] = style;
+			}
+		}
+		else
+		{
+			styles[i++] = HighlightStyle::NORMAL;
+		}
+
+		if (!isspace(static_cast<unsigned char>(ch)))
+		{
+			lineStart = false;
+		}
+	}
+
+	return state;
+}
+
+void AppendHighlightSpans(const HighlightStyle* styles, size_t size, std::vector<HighlightSpan>& spans)
+{
+	size_t i = 0;
+	while (i < size)
+	{
+		HighlightStyle style = styles[i];
+		size_t runEnd = i + 1;
+		while (runEnd < size && runEnd - i < UINT16_MAX && styles[runEnd] == style)
+		{
+			runEnd++;
+		}
+
+		if (style != HighlightStyle::NORMAL)
+		{
+			spans.push_back({ static_cast<uint32_t>(i), static_cast<uint16_t>(runEnd - i), style });
+		}
+		i = runEnd;
+	}
+}
+
+TerminalColor GetHighlightColor(HighlightStyle style)
+{
+	switch (style)
+	{
+	case HighlightStyle::KEYWORD:
+		return { 198, 120, 221 };
+	case HighlightStyle::TYPE:
+		return { 229, 192, 123 };
+	case HighlightStyle::STRING:
+		return { 152, 195, 121 };
+	case HighlightStyle::NUMBER:
+		return { 209, 154, 102 };
+	case HighlightStyle::COMMENT:
+		return { 127, 132, 142 };
+	case HighlightStyle::PREPROCESSOR:
+		return { 97, 175, 239 };
+	case HighlightStyle::NORMAL:
+		break;
+	}
+
+	return { 255, 255, 255 };
+}
@@ -0,0 +1,107 @@
+/*
+ * HighlightWorker.cpp - syntax highlighting on a background thread.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <HighlightWorker.hpp>
+
+#include <chrono>
+
+HighlightWorker::HighlightWorker(const HighlightSyntax& syntax)
+	: m_Syntax(syntax)
+{
+	m_Thread = std::thread(&HighlightWorker::WorkerLoop, this);
+}
+
+HighlightWorker::~HighlightWorker()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_JobReady.notify_all();
+	
+	m_Thread.join();
+}
+
+bool HighlightWorker::IsBusy() const
+{
+	return m_Busy;
+}
+
+void HighlightWorker::Start(Job job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Job = std::move(job);
+		m_HasJob = true;
+		m_HasResult = false;
+	}
+	m_Busy = true;
+	m_JobReady.notify_all();
+}
+
+bool HighlightWorker::TakeResult(Result& result, int timeout)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	if (!m_ResultReady.wait_for(lock, std::chrono::milliseconds(timeout), [&]() { return m_HasResult; }))
+	{
+		return false;
+	}
+
+	result = std::move(m_Result);
+	m_HasResult = false;
+	m_Busy = false;
+	return true;
+}
+
+void HighlightWorker::WorkerLoop()
+{
+	while (true)
+	{
+		Job job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobReady.wait(lock, [&]() { return m_Stopping || m_HasJob; });
+			if (m_Stopping)
+			{
+				return;
+			}
+
+			job = std::move(m_Job);
+			m_HasJob = false;
+		}
+
+		Result result;
+		result.version = job.version;
+		result.firstRow = job.firstRow;
+		result.spanCounts.resize(job.lines.size());
+		result.endStates.resize(job.lines.size());
+		
+		HighlightState state = job.startState;
+		for (size_t i = 0; i < job.lines.size(); i++)
+		{
+			if (m_Styles.size() < job.lines[i].size())
+			{
+				m_Styles.resize(job.lines[i].size());
+			}
+			
+			state = HighlightLine(m_Syntax, job.lines[i].data(), job.lines[i].size(), state, m_Styles.data());
+			result.endStates[i] = state;
+
+			size_t spanCount = result.spans.size();
+			AppendHighlightSpans(m_Styles.data(), job.lines[i].size(), result.spans);
+			result.spanCounts[i] = result.spans.size() - spanCount;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Result = std::move(result);
+			m_HasResult = true;
+		}
+		m_ResultReady.notify_all();
+	}
+}
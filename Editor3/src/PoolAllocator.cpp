@@ -0,0 +1,89 @@
+/*
+ * PoolAllocator.cpp - size class pool of small blocks.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <PoolAllocator.hpp>
+
+#include <new>
+
+size_t BlockPool::GetSizeClass(size_t size)
+{
+	size_t sizeClass = 0;
+	while ((size_t(1) << (sizeClass + MIN_BLOCK_BITS)) < size)
+	{
+		sizeClass++;
+	}
+	return sizeClass;
+}
+
+void* BlockPool::Allocate(size_t size)
+{
+	if (size > (size_t(1) << MAX_BLOCK_BITS))
+	{
+		m_BigBlocksSize += size;
+		return ::operator new(size);
+	}
+
+	size_t sizeClass = GetSizeClass(size);
+	if (m_FreeLists[sizeClass] != nullptr)
+	{
+		FreeBlock* block = m_FreeLists[sizeClass];
+		m_FreeLists[sizeClass] = block->next;
+		return block;
+	}
+
+	// The rest of the old slab is lost, it is less than the biggest block.
+	size_t blockSize = size_t(1) << (sizeClass + MIN_BLOCK_BITS);
+	if (m_SlabCursor == nullptr || static_cast<size_t>(m_SlabEnd - m_SlabCursor) < blockSize)
+	{
+		m_Slabs.emplace_back(new char[SLAB_SIZE]);
+		m_SlabCursor = m_Slabs.back().get();
+		m_SlabEnd = m_SlabCursor + SLAB_SIZE;
+	}
+
+	void* block = m_SlabCursor;
+	m_SlabCursor += blockSize;
+	return block;
+}
+
+void BlockPool::Deallocate(void* block, size_t size)
+{
+	if (block == nullptr)
+	{
+		return;
+	}
+
+	if (size > (size_t(1) << MAX_BLOCK_BITS))
+	{
+		m_BigBlocksSize -= size;
+		::operator delete(block);
+		return;
+	}
+
+	size_t sizeClass = GetSizeClass(size);
+	FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+	freeBlock->next = m_FreeLists[sizeClass];
+	m_FreeLists[sizeClass] = freeBlock;
+}
+
+void BlockPool::Clear()
+{
+	for (FreeBlock*& freeList : m_FreeLists)
+	{
+		freeList = nullptr;
+	}
+
+	std::vector<std::unique_ptr<char[]>>().swap(m_Slabs);
+	m_SlabCursor = nullptr;
+	m_SlabEnd = nullptr;
+}
+
+BlockPool& GetHighlightPool()
+{
+	static BlockPool pool;
+	return pool;
+}
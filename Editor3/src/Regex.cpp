@@ -0,0 +1,538 @@
+/*
+ * Regex.cpp - regular expressions matched with a lazily built DFA.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Regex.hpp>
+
+#include <algorithm>
+#include <cctype>
+
+Regex::Regex(const std::string& pattern)
+	: m_Pattern(&pattern)
+{
+	Fragment fragment = this->ParseAlternation();
+	if (m_Pos != pattern.size())
+	{
+		throw RegexSyntaxError("unmatched ')'");
+	}
+
+	int match = this->AddState(NfaState::MATCH);
+	this->Patch(fragment, match);
+	m_Start = fragment.start;
+
+	m_Pattern = nullptr;
+}
+
+int Regex::AddState(NfaState::Type type)
+{
+	m_States.push_back(NfaState());
+	m_States.back().type = type;
+	return m_States.size() - 1;
+}
+
+void Regex::Patch(const Fragment& fragment, int state)
+{
+	for (int out : fragment.outs)
+	{
+		if (out & 1)
+		{
+			m_States[out >> 1].out1 = state;
+		}
+		else
+		{
+			m_States[out >> 1].out = state;
+		}
+	}
+}
+
+Regex::Fragment Regex::ParseAlternation()
+{
+	Fragment left = this->ParseConcatenation();
+	
+	while (m_Pos < m_Pattern->size() && (*m_Pattern)[m_Pos] == '|')
+	{
+		m_Pos++;
+		Fragment right = this->ParseConcatenation();
+
+		int split = this->AddState(NfaState::SPLIT);
+		m_States[split].out = left.start;
+		m_States[split].out1 = right.start;
+
+		left.start = split;
+		left.outs.insert(left.outs.end(), right.outs.begin(), right.outs.end());
+	}
+
+	return left;
+}
+
+Regex::Fragment Regex::ParseConcatenation()
+{
+	int empty = this->AddState(NfaState::EMPTY);
+	Fragment result = { empty, { empty << 1 } };
+	
+	while (m_Pos < m_Pattern->size() && (*m_Pattern)[m_Pos] != '|' && (*m_Pattern)[m_Pos] != ')')
+	{
+		Fragment next = this->ParseRepetition();
+		this->Patch(result, next.start);
+		result.outs = std::move(next.outs);
+	}
+
+	return result;
+}
+
+Regex::Fragment Regex::ParseRepetition()
+{
+	Fragment atom = this->ParseAtom();
+
+	while (m_Pos < m_Pattern->size())
+	{
+		char op = (*m_Pattern)[m_Pos];
+		if (op != '*' && op != '+' && op != '?')
+		{
+			break;
+		}
+		m_Pos++;
+
+		int split = this->AddState(NfaState::SPLIT);
+		m_States[split].out = atom.start;
+
+		switch (op)
+		{
+		case '*':
+			this->Patch(atom, split);
+			atom = { split, { (split << 1) | 1 } };
+			break;
+		case '+':
+			this->Patch(atom, split);
+			atom.outs = { (split << 1) | 1 };
+			break;
+		case '?':
+			atom.start = split;
+			atom.outs.push_back((split << 1) | 1);
+			break;
+		}
+	}
+
+	return atom;
+}
+
+Regex::Fragment Regex::ParseAtom()
+{
+	char ch = (*m_Pattern)[m_Pos++];
+
+	int state;
+	switch (ch)
+	{
+	case '(':
+	{
+		Fragment group = this->ParseAlternation();
+		if (m_Pos >= m_Pattern->size() || (*m_Pattern)[m_Pos] != ')')
+		{
+			throw RegexSyntaxError("missing ')'");
+		}
+		m_Pos++;
+		return group;
+	}
+
+	case '*':
+	case '+':
+	case '?':
+		throw RegexSyntaxError("nothing to repeat");
+
+	case '^':
+		state = this->AddState(NfaState::BOL);
+		break;
+
+	case '$':
+		state = this->AddState(NfaState::EOL);
+		break;
+
+	case '.':
+		state = this->AddState(NfaState::CHARS);
+		m_States[state].chars.set();
+		break;
+
+	case '[':
+		state = this->AddState(NfaState::CHARS);
+		m_States[state].chars = this->ParseClass();
+		break;
+
+	case '\\':
+		state = this->AddState(NfaState::CHARS);
+		m_States[state].chars = this->ParseEscape();
+		break;
+
+	default:
+		state = this->AddState(NfaState::CHARS);
+		m_States[state].chars.set(static_cast<unsigned char>(ch));
+		break;
+	}
+
+	return { state, { state << 1 } };
+}
+
+std::bitset<256> Regex::ParseClass()
+{
+	std::bitset<256> chars;
+	
+	bool negated = m_Pos < m_Pattern->size() && (*m_Pattern)[m_Pos] == '^';
+	if (negated)
+	{
+		m_Pos++;
+	}
+
+	bool first = true;
+	while (true)
+	{
+		if (m_Pos >= m_Pattern->size())
+		{
+			throw RegexSyntaxError("missing ']'");
+		}
+
+		char ch = (*m_Pattern)[m_Pos++];
+		if (ch == ']' && !first)
+		{
+			break;
+		}
+		first = false;
+
+		unsigned char from = ch;
+		if (ch == '\\')
+		{
+			std::bitset<256> escaped = this->ParseEscape();
+			if (escaped.count() != 1)
+			{
+				chars |= escaped;
+				continue;
+			}
+
+			// The escape of one character (like \t) is the character it stands for, not the letter after '\'.
+			from = escaped._Find_first();
+		}
+
+		unsigned char to = from;
+		if (m_Pos + 1 < m_Pattern->size() && (*m_Pattern)[m_Pos] == '-' && (*m_Pattern)[m_Pos + 1] != ']')
+		{
+			to = (*m_Pattern)[m_Pos + 1];
+			m_Pos += 2;
+			if (to == '\\')
+			{
+				std::bitset<256> escaped = this->ParseEscape();
+				if (escaped.count() != 1)
+				{
+					throw RegexSyntaxError("wrong range in a character class");
+				}
+				to = escaped._Find_first();
+			}
+
+			if (to < from)
+			{
+				throw RegexSyntaxError("wrong range in a character class");
+			}
+		}
+
+		for (int i = from; i <= to; i++)
+		{
+			chars.set(i);
+		}
+	}
+
+	if (negated)
+	{
+		chars.flip();
+	}
+
+	return chars;
+}
+
+std::bitset<256> Regex::ParseEscape()
+{
+	if (m_Pos >= m_Pattern->size())
+	{
+		throw RegexSyntaxError("trailing '\\'");
+	}
+
+	char ch = (*m_Pattern)[m_Pos++];
+	
+	std::bitset<256> chars;
+	switch (ch)
+	{
+	case 'd':
+	case 'D':
+		for (int i = '0'; i <= '9'; i++)
+		{
+			chars.set(i);
+		}
+		break;
+	case 'w':
+	case 'W':
+		for (int i = 0; i < 256; i++)
+		{
+			chars.set(i, isalnum(i) || i == '_');
+		}
+		break;
+	case 's':
+	case 'S':
+		for (char space : std::string(" \t\r\n\f\v"))
+		{
+			chars.set(space);
+		}
+		break;
+	case 't':
+		chars.set('\t');
+		return chars;
+	default:
+		chars.set(static_cast<unsigned char>(ch));
+		return chars;
+	}
+
+	if (ch == 'D' || ch == 'W' || ch == 'S')
+	{
+		chars.flip();
+	}
+
+	return chars;
+}
+
+RegexMatcher::RegexMatcher(std::shared_ptr<const Regex> regex)
+	: m_Regex(regex)
+{
+	m_Anchored.unanchored = false;
+	m_Unanchored.unanchored = true;
+	this->ResetDfa(m_Anchored);
+	this->ResetDfa(m_Unanchored);
+}
+
+void RegexMatcher::ResetDfa(Dfa& dfa)
+{
+	dfa.states.clear();
+	dfa.indices.clear();
+
+	std::vector<int> set;
+	this->GetDfaState(dfa, set); // DEAD_STATE.
+
+	this->AddClosure(set, m_Regex->m_Start, true, false);
+	dfa.startAtBol = this->GetDfaState(dfa, set);
+
+	set.clear();
+	this->AddClosure(set, m_Regex->m_Start, false, false);
+	dfa.startInside = this->GetDfaState(dfa, set);
+}
+
+void RegexMatcher::AddClosure(std::vector<int>& set, int state, bool atBol, bool atEol) const
+{
+	std::vector<int> stack = { state };
+	std::vector<bool> visited(m_Regex->m_States.size(), false);
+	
+	while (!stack.empty())
+	{
+		int current = stack.back();
+		stack.pop_back();
+
+		if (current == -1 || visited[current])
+		{
+			continue;
+		}
+		visited[current] = true;
+
+		const Regex::NfaState& nfaState = m_Regex->m_States[current];
+		switch (nfaState.type)
+		{
+		case Regex::NfaState::SPLIT:
+			stack.push_back(nfaState.out1);
+			stack.push_back(nfaState.out);
+			break;
+		case Regex::NfaState::EMPTY:
+			stack.push_back(nfaState.out);
+			break;
+		case Regex::NfaState::BOL:
+			if (atBol)
+			{
+				stack.push_back(nfaState.out);
+			}
+			break;
+		case Regex::NfaState::EOL:
+			// Kept in the set, so the end of the line may be checked later.
+			set.push_back(current);
+			if (atEol)
+			{
+				stack.push_back(nfaState.out);
+			}
+			break;
+		case Regex::NfaState::CHARS:
+		case Regex::NfaState::MATCH:
+			set.push_back(current);
+			break;
+		}
+	}
+}
+
+int RegexMatcher::GetDfaState(Dfa& dfa, std::vector<int>& set)
+{
+	std::sort(set.begin(), set.end());
+	set.erase(std::unique(set.begin(), set.end()), set.end());
+
+	auto found = dfa.indices.find(set);
+	if (found != dfa.indices.end())
+	{
+		return found->second;
+	}
+
+	DfaState state;
+	state.nfaStates = set;
+	state.accepting = false;
+	state.acceptingAtEnd = false;
+	std::fill(std::begin(state.next), std::end(state.next), UNKNOWN_STATE);
+
+	std::vector<int> atEnd;
+	for (int nfaState : set)
+	{
+		Regex::NfaState::Type type = m_Regex->m_States[nfaState].type;
+		if (type == Regex::NfaState::MATCH)
+		{
+			state.accepting = true;
+		}
+		else if (type == Regex::NfaState::EOL)
+		{
+			this->AddClosure(atEnd, m_Regex->m_States[nfaState].out, false, true);
+		}
+	}
+	
+	state.acceptingAtEnd = state.accepting;
+	for (int nfaState : atEnd)
+	{
+		if (m_Regex->m_States[nfaState].type == Regex::NfaState::MATCH)
+		{
+			state.acceptingAtEnd = true;
+		}
+	}
+
+	dfa.states.push_back(std::move(state));
+	dfa.indices[set] = dfa.states.size() - 1;
+	return dfa.states.size() - 1;
+}
+
+int RegexMatcher::Step(Dfa& dfa, int state, unsigned char ch)
+{
+	int next = dfa.states[state].next[ch];
+	if (next != UNKNOWN_STATE)
+	{
+		return next;
+	}
+
+	std::vector<int> set;
+	for (int nfaState : dfa.states[state].nfaStates)
+	{
+		const Regex::NfaState& nfa = m_Regex->m_States[nfaState];
+		if (nfa.type == Regex::NfaState::CHARS && nfa.chars.test(ch))
+		{
+			this->AddClosure(set, nfa.out, false, false);
+		}
+	}
+
+	if (dfa.unanchored)
+	{
+		this->AddClosure(set, m_Regex->m_Start, false, false);
+	}
+
+	next = this->GetDfaState(dfa, set);
+	dfa.states[state].next[ch] = next;
+	return next;
+}
+
+long RegexMatcher::FindEarliestEnd(const char* line, size_t size, size_t start)
+{
+	int state = start == 0 ? m_Unanchored.startAtBol : m_Unanchored.startInside;
+	
+	for (size_t i = start; ; i++)
+	{
+		const DfaState& current = m_Unanchored.states[state];
+		if (current.accepting)
+		{
+			return i;
+		}
+
+		if (i == size)
+		{
+			return current.acceptingAtEnd ? static_cast<long>(size) : -1;
+		}
+
+		state = this->Step(m_Unanchored, state, line[i]);
+		if (state == DEAD_STATE)
+		{
+			return -1;
+		}
+	}
+}
+
+long RegexMatcher::FindLongestEnd(const char* line, size_t size, size_t start)
+{
+	int state = start == 0 ? m_Anchored.startAtBol : m_Anchored.startInside;
+	long longest = -1;
+	
+	for (size_t i = start; ; i++)
+	{
+		const DfaState& current = m_Anchored.states[state];
+		if (current.accepting || (i == size && current.acceptingAtEnd))
+		{
+			longest = i;
+		}
+
+		if (i == size)
+		{
+			return longest;
+		}
+
+		state = this->Step(m_Anchored, state, line[i]);
+		if (state == DEAD_STATE)
+		{
+			return longest;
+		}
+	}
+}
+
+void RegexMatcher::FindAll(const char* line, size_t size, std::vector<LineMatch>& matches)
+{
+	if (m_Anchored.states.size() > MAX_DFA_STATES)
+	{
+		this->ResetDfa(m_Anchored);
+	}
+	if (m_Unanchored.states.size() > MAX_DFA_STATES)
+	{
+		this->ResetDfa(m_Unanchored);
+	}
+	
+	size_t pos = 0;
+	while (pos <= size)
+	{
+		long earliestEnd = this->FindEarliestEnd(line, size, pos);
+		if (earliestEnd == -1)
+		{
+			return;
+		}
+
+		// The leftmost match starts not later than the earliest ending one.
+		bool found = false;
+		for (size_t start = pos; start <= static_cast<size_t>(earliestEnd); start++)
+		{
+			long end = this->FindLongestEnd(line, size, start);
+			if (end > static_cast<long>(start))
+			{
+				matches.push_back({ static_cast<int>(start), static_cast<int>(end - start) });
+				pos = end;
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+		{
+			// Only empty matches start there, they are not reported.
+			pos = earliestEnd + 1;
+		}
+	}
+}
@@ -0,0 +1,165 @@
+/*
+ * RegexSearch.cpp - parallel regular expression search over a snapshot of the buffer.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <RegexSearch.hpp>
+
+RegexSearch::RegexSearch(int workerCount)
+{
+	if (workerCount <= 0)
+	{
+		workerCount = std::thread::hardware_concurrency();
+	}
+	if (workerCount <= 0)
+	{
+		workerCount = 1;
+	}
+
+	for (int i = 0; i < workerCount; i++)
+	{
+		m_Workers.emplace_back(&RegexSearch::WorkerLoop, this);
+	}
+}
+
+RegexSearch::~RegexSearch()
+{
+	this->Cancel();
+	
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_JobChanged.notify_all();
+
+	for (std::thread& worker : m_Workers)
+	{
+		worker.join();
+	}
+}
+
+void RegexSearch::Start(std::shared_ptr<const Regex> regex, std::shared_ptr<const BufferSnapshot> snapshot, int firstLine)
+{
+	this->Cancel();
+
+	std::shared_ptr<Job> job = std::make_shared<Job>();
+	job->regex = regex;
+	job->snapshot = snapshot;
+	job->chunkCount = (snapshot->GetLineCount() + CHUNK_LINES - 1) / CHUNK_LINES;
+	job->firstChunk = job->chunkCount == 0 ? 0 : (firstLine / CHUNK_LINES) % job->chunkCount;
+	job->chunksLeft = job->chunkCount;
+	
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Job = job;
+		m_JobNumber++;
+	}
+	m_JobChanged.notify_all();
+}
+
+void RegexSearch::Cancel()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Job != nullptr)
+	{
+		m_Job->cancelled = true;
+		m_Job = nullptr;
+	}
+}
+
+bool RegexSearch::TakeMatches(std::vector<BufferMatch>& matches)
+{
+	std::shared_ptr<Job> job;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		job = m_Job;
+	}
+
+	if (job == nullptr)
+	{
+		return false;
+	}
+
+	// Read before taking the matches: if it is 0, then all matches are already in found.
+	bool done = job->chunksLeft == 0;
+
+	std::lock_guard<std::mutex> lock(job->mutex);
+	matches.insert(matches.end(), job->found.begin(), job->found.end());
+	job->found.clear();
+	
+	return !done;
+}
+
+void RegexSearch::WorkerLoop()
+{
+	unsigned seenJobNumber = 0;
+	
+	while (true)
+	{
+		std::shared_ptr<Job> job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobChanged.wait(lock, [&]() { return m_Stopping || (m_JobNumber != seenJobNumber && m_Job != nullptr); });
+			if (m_Stopping)
+			{
+				return;
+			}
+
+			job = m_Job;
+			seenJobNumber = m_JobNumber;
+		}
+
+		RegexMatcher matcher(job->regex);
+		while (!job->cancelled)
+		{
+			int chunk = job->nextChunk++;
+			if (chunk >= job->chunkCount)
+			{
+				break;
+			}
+
+			this->SearchChunk(*job, matcher, (job->firstChunk + chunk) % job->chunkCount);
+		}
+	}
+}
+
+void RegexSearch::SearchChunk(Job& job, RegexMatcher& matcher, int chunk)
+{
+	const BufferSnapshot& snapshot = *job.snapshot;
+	
+	int first = chunk * CHUNK_LINES;
+	int last = first + CHUNK_LINES;
+	if (last > snapshot.GetLineCount())
+	{
+		last = snapshot.GetLineCount();
+	}
+
+	std::vector<BufferMatch> found;
+	std::vector<LineMatch> lineMatches;
+	for (int line = first; line < last; line++)
+	{
+		if ((line - first) % CANCEL_CHECK_LINES == 0 && job.cancelled)
+		{
+			return;
+		}
+		
+		size_t start = snapshot.lineStarts[line];
+		size_t size = snapshot.lineStarts[line + 1] - start;
+		
+		lineMatches.clear();
+		matcher.FindAll(snapshot.text.data() + start, size, lineMatches);
+		for (const LineMatch& match : lineMatches)
+		{
+			found.push_back({ line, match.start, match.length });
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(job.mutex);
+		job.found.insert(job.found.end(), found.begin(), found.end());
+	}
+	job.chunksLeft--;
+}
@@ -0,0 +1,99 @@
+/*
+ * RenderColumns.cpp - the render X coordinates of the checkpoints of a long row.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <RenderColumns.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+RenderColumns::RenderColumns(const char* real, size_t size, int tabStop)
+{
+	this->Update(real, size, tabStop, 0);
+}
+
+void RenderColumns::Update(const char* real, size_t size, int tabStop, size_t from)
+{
+	from = std::min(from, size);
+
+	// The render X coordinates before the first tab are the real ones, so a row without tabs needs no checkpoints.
+	bool hadTabs = m_FirstTab >= 0;
+	if (!hadTabs || static_cast<size_t>(m_FirstTab) >= from)
+	{
+		const void* tab = std::memchr(real + from, '\t', size - from);
+		m_FirstTab = tab == nullptr ? -1 : static_cast<const char*>(tab) - real;
+	}
+
+	if (m_FirstTab < 0)
+	{
+		m_Rx.clear();
+		return;
+	}
+
+	// The scan resumes from the last checkpoint not after from, it is still valid.
+	size_t checkpoint = from / RENDER_COLUMNS_STEP;
+	if (hadTabs)
+	{
+		checkpoint = std::min(checkpoint, m_Rx.size() - 1);
+	}
+	else
+	{
+		m_Rx.clear();
+		for (size_t i = 0; i <= checkpoint; i++)
+		{
+			m_Rx.push_back(i * RENDER_COLUMNS_STEP);
+		}
+	}
+
+	m_Rx.resize(checkpoint + 1);
+	m_Rx.reserve(size / RENDER_COLUMNS_STEP + 1);
+
+	// The characters between the tabs are one column wide, so their checkpoints are counted and not scanned.
+	int rx = m_Rx[checkpoint];
+	size_t cx = checkpoint * RENDER_COLUMNS_STEP;
+	size_t next = cx + RENDER_COLUMNS_STEP;
+	while (cx < size)
+	{
+		const void* tab = std::memchr(real + cx, '\t', size - cx);
+		size_t end = tab == nullptr ? size : static_cast<const char*>(tab) - real;
+
+		for (; next <= end && next < size; next += RENDER_COLUMNS_STEP)
+		{
+			m_Rx.push_back(rx + (next - cx));
+		}
+
+		rx += end - cx;
+		cx = end;
+		if (cx < size)
+		{
+			rx += tabStop - (rx % tabStop);
+			cx++;
+		}
+	}
+}
+
+void RenderColumns::FindByCx(int cx, int& checkpointCx, int& checkpointRx) const
+{
+	size_t checkpoint = cx <= 0 ? 0 : cx / RENDER_COLUMNS_STEP;
+	if (checkpoint >= m_Rx.size())
+	{
+		checkpoint = m_Rx.size() - 1;
+	}
+
+	checkpointCx = checkpoint * RENDER_COLUMNS_STEP;
+	checkpointRx = m_Rx[checkpoint];
+}
+
+void RenderColumns::FindByRx(int rx, int& checkpointCx, int& checkpointRx) const
+{
+	// The first checkpoint after rx, the one before it is the last one not after rx. The first checkpoint is always 0.
+	auto next = std::upper_bound(m_Rx.begin() + 1, m_Rx.end(), rx);
+	size_t checkpoint = next - m_Rx.begin() - 1;
+
+	checkpointCx = checkpoint * RENDER_COLUMNS_STEP;
+	checkpointRx = m_Rx[checkpoint];
+}
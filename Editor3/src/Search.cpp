@@ -0,0 +1,270 @@
+/*
+ * Search.cpp - substring search over the editor rows.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Search.hpp>
+
+#include <string.h>
+
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+long FindSubstring(const char* haystack, size_t haystackSize, const char* needle, size_t needleSize, size_t start)
+{
+	if (needleSize == 0 || needleSize > haystackSize || start > haystackSize - needleSize)
+	{
+		return -1;
+	}
+
+	// The last position where the needle may start.
+	size_t last = haystackSize - needleSize;
+	size_t i = start;
+
+#ifdef __SSE2__
+	const __m128i first = _mm_set1_epi8(needle[0]);
+	const __m128i lastByte = _mm_set1_epi8(needle[needleSize - 1]);
+
+	// Both loads read 16 bytes, so the block must fit: i + needleSize - 1 + 16 <= haystackSize.
+	while (i + 16 <= last + 1)
+	{
+		__m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+		__m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + needleSize - 1));
+
+		unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, lastByte)));
+		while (mask != 0)
+		{
+			int bit = __builtin_ctz(mask);
+			if (needleSize <= 2 || memcmp(haystack + i + bit + 1, needle + 1, needleSize - 2) == 0)
+			{
+				return i + bit;
+			}
+			mask &= mask - 1;
+		}
+
+		i += 16;
+	}
+#endif
+
+	for (; i <= last; i++)
+	{
+		const char* candidate = static_cast<const char*>(memchr(haystack + i, needle[0], last - i + 1));
+		if (candidate == nullptr)
+		{
+			return -1;
+		}
+
+		i = candidate - haystack;
+		if (haystack[i + needleSize - 1] == needle[needleSize - 1] && memcmp(haystack + i, needle, needleSize) == 0)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+long FindLastSubstring(const char* haystack, size_t haystackSize, const char* needle, size_t needleSize, size_t end)
+{
+	long found = -1;
+	long at = FindSubstring(haystack, haystackSize, needle, needleSize, 0);
+	while (at != -1 && static_cast<size_t>(at) < end)
+	{
+		found = at;
+		at = FindSubstring(haystack, haystackSize, needle, needleSize, at + 1);
+	}
+
+	return found;
+}
+
+void MatchIndex::Clear()
+{
+	m_Lines.clear();
+	m_Matches.clear();
+	m_Pending.clear();
+	m_Count = 0;
+}
+
+size_t MatchIndex::GetMatchCount() const
+{
+	return m_Count + m_Pending.size();
+}
+
+void MatchIndex::AddMatches(const std::vector<BufferMatch>& matches)
+{
+	m_Pending.insert(m_Pending.end(), matches.begin(), matches.end());
+}
+
+void MatchIndex::MergePending() const
+{
+	if (m_Pending.empty())
+	{
+		return;
+	}
+
+	std::sort(m_Pending.begin(), m_Pending.end(), [](const BufferMatch& a, const BufferMatch& b)
+	{
+		return a.line < b.line || (a.line == b.line && a.start < b.start);
+	});
+
+	std::vector<int> lines;
+	std::vector<std::vector<LineMatch>> matches;
+	lines.reserve(m_Lines.size() + m_Pending.size());
+	matches.reserve(m_Lines.size() + m_Pending.size());
+	
+	size_t old = 0;
+	size_t pending = 0;
+	while (old < m_Lines.size() || pending < m_Pending.size())
+	{
+		if (pending == m_Pending.size() || (old < m_Lines.size() && m_Lines[old] < m_Pending[pending].line))
+		{
+			lines.push_back(m_Lines[old]);
+			matches.push_back(std::move(m_Matches[old]));
+			old++;
+		}
+		else
+		{
+			int line = m_Pending[pending].line;
+			lines.push_back(line);
+			matches.emplace_back();
+			for (; pending < m_Pending.size() && m_Pending[pending].line == line; pending++)
+			{
+				matches.back().push_back({ m_Pending[pending].start, m_Pending[pending].length });
+			}
+		}
+	}
+
+	m_Count += m_Pending.size();
+	m_Pending.clear();
+	m_Lines = std::move(lines);
+	m_Matches = std::move(matches);
+}
+
+size_t MatchIndex::LowerBound(int line) const
+{
+	this->MergePending();
+	return std::lower_bound(m_Lines.begin(), m_Lines.end(), line) - m_Lines.begin();
+}
+
+void MatchIndex::SetLineMatches(int line, const std::vector<LineMatch>& matches)
+{
+	size_t i = this->LowerBound(line);
+	bool present = i < m_Lines.size() && m_Lines[i] == line;
+
+	if (present)
+	{
+		m_Count -= m_Matches[i].size();
+		if (matches.empty())
+		{
+			m_Lines.erase(m_Lines.begin() + i);
+			m_Matches.erase(m_Matches.begin() + i);
+			return;
+		}
+		
+		m_Matches[i] = matches;
+	}
+	else
+	{
+		if (matches.empty())
+		{
+			return;
+		}
+
+		m_Lines.insert(m_Lines.begin() + i, line);
+		m_Matches.insert(m_Matches.begin() + i, matches);
+	}
+	
+	m_Count += matches.size();
+}
+
+void MatchIndex::InsertLines(int at, int count)
+{
+	for (size_t i = this->LowerBound(at); i < m_Lines.size(); i++)
+	{
+		m_Lines[i] += count;
+	}
+}
+
+void MatchIndex::EraseLines(int at, int count)
+{
+	size_t first = this->LowerBound(at);
+	size_t last = this->LowerBound(at + count);
+
+	for (size_t i = first; i < last; i++)
+	{
+		m_Count -= m_Matches[i].size();
+	}
+	m_Lines.erase(m_Lines.begin() + first, m_Lines.begin() + last);
+	m_Matches.erase(m_Matches.begin() + first, m_Matches.begin() + last);
+
+	for (size_t i = first; i < m_Lines.size(); i++)
+	{
+		m_Lines[i] -= count;
+	}
+}
+
+const std::vector<LineMatch>* MatchIndex::GetLineMatches(int line) const
+{
+	size_t i = this->LowerBound(line);
+	if (i < m_Lines.size() && m_Lines[i] == line)
+	{
+		return &m_Matches[i];
+	}
+
+	return nullptr;
+}
+
+bool MatchIndex::FindNearest(int line, int x, bool forward, BufferMatch& result) const
+{
+	size_t i = this->LowerBound(line);
+	if (m_Lines.empty())
+	{
+		return false;
+	}
+
+	auto byStart = [](const LineMatch& match, int x) { return match.start < x; };
+	
+	if (forward)
+	{
+		if (i < m_Lines.size() && m_Lines[i] == line)
+		{
+			const std::vector<LineMatch>& matches = m_Matches[i];
+			auto found = std::lower_bound(matches.begin(), matches.end(), x + 1, byStart);
+			if (found != matches.end())
+			{
+				result = { line, found->start, found->length };
+				return true;
+			}
+			i++;
+		}
+
+		if (i == m_Lines.size())
+		{
+			i = 0;
+		}
+		result = { m_Lines[i], m_Matches[i].front().start, m_Matches[i].front().length };
+		return true;
+	}
+
+	if (i < m_Lines.size() && m_Lines[i] == line)
+	{
+		const std::vector<LineMatch>& matches = m_Matches[i];
+		auto found = std::lower_bound(matches.begin(), matches.end(), x, byStart);
+		if (found != matches.begin())
+		{
+			found--;
+			result = { line, found->start, found->length };
+			return true;
+		}
+	}
+
+	i = i == 0 ? m_Lines.size() - 1 : i - 1;
+	result = { m_Lines[i], m_Matches[i].back().start, m_Matches[i].back().length };
+	return true;
+}
@@ -0,0 +1,223 @@
+/*
+ * TerminalColors.cpp - the escape sequences of the colors for the color depth of a terminal.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <TerminalColors.hpp>
+
+#include <charconv>
+#include <stdlib.h>
+#include <string.h>
+
+/// The levels of a channel in the 6x6x6 color cube of the palette.
+static const int CUBE_LEVELS[6] = { 0, 95, 135, 175, 215, 255 };
+
+/// The tables that map the RGB colors to the palette. They are computed once, so a color is mapped by a few lookups.
+struct ColorTables
+{
+	/// The nearest level of the color cube (0 - 5) for every value of a channel.
+	uint8_t cubeLevel[256];
+	/// The nearest shade of the gray ramp (0 - 23) for every value of a channel.
+	uint8_t grayLevel[256];
+	/// The nearest of the 16 basic colors for every color of the palette.
+	uint8_t basicColor[256];
+
+	ColorTables()
+	{
+		for (int value = 0; value < 256; value++)
+		{
+			int level = 0;
+			for (int i = 1; i < 6; i++)
+			{
+				if (abs(CUBE_LEVELS[i] - value) < abs(CUBE_LEVELS[level] - value))
+				{
+					level = i;
+				}
+			}
+			cubeLevel[value] = level;
+
+			// The shades are 8, 18, ..., 238.
+			int gray = (value - 3) / 10;
+			grayLevel[value] = gray < 0 ? 0 : (gray > 23 ? 23 : gray);
+		}
+
+		for (int index = 0; index < 256; index++)
+		{
+			TerminalColor color = GetPaletteColor(index);
+			int nearest = 0;
+			int nearestDistance = INT32_MAX;
+			for (int basic = 0; basic < 16; basic++)
+			{
+				int distance = Distance(color, GetPaletteColor(basic));
+				if (distance < nearestDistance)
+				{
+					nearest = basic;
+					nearestDistance = distance;
+				}
+			}
+			basicColor[index] = nearest;
+		}
+	}
+
+	/// Return the squared distance between the colors.
+	static int Distance(TerminalColor a, TerminalColor b)
+	{
+		return (a.r - b.r) * (a.r - b.r) + (a.g - b.g) * (a.g - b.g) + (a.b - b.b) * (a.b - b.b);
+	}
+
+	/// Return the index of the nearest color of the palette above the 16 basic colors, which may be changed by the user.
+	int GetPaletteIndex(TerminalColor color) const
+	{
+		int cube = 16 + cubeLevel[color.r] * 36 + cubeLevel[color.g] * 6 + cubeLevel[color.b];
+		int gray = 232 + grayLevel[(color.r + color.g + color.b) / 3];
+		return Distance(color, GetPaletteColor(gray)) < Distance(color, GetPaletteColor(cube)) ? gray : cube;
+	}
+};
+
+/// Return the tables, they are computed on the first call.
+static const ColorTables& GetColorTables()
+{
+	static const ColorTables tables;
+	return tables;
+}
+
+/// Return the value limited to a channel (0 - 255).
+static int ClampChannel(int value)
+{
+	return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+/// Append the decimal number.
+static void AppendNumber(std::string& output, int number)
+{
+	char buffer[16];
+	auto result = std::to_chars(buffer, buffer + sizeof(buffer), number);
+	output.append(buffer, result.ptr - buffer);
+}
+
+TerminalColorDepth DetectColorDepth(const char* term, const char* colorTerm)
+{
+	if (colorTerm != nullptr && (strcmp(colorTerm, "truecolor") == 0 || strcmp(colorTerm, "24bit") == 0))
+	{
+		return TerminalColorDepth::TRUE_COLOR;
+	}
+	if (term != nullptr && strstr(term, "direct") != nullptr)
+	{
+		return TerminalColorDepth::TRUE_COLOR;
+	}
+	if (term != nullptr && strstr(term, "256color") != nullptr)
+	{
+		return TerminalColorDepth::COLORS_256;
+	}
+	return TerminalColorDepth::COLORS_16;
+}
+
+TerminalColor GetPaletteColor(int index)
+{
+	static const TerminalColor BASIC_COLORS[16] =
+	{
+		{ 0, 0, 0 }, { 205, 0, 0 }, { 0, 205, 0 }, { 205, 205, 0 }, { 0, 0, 238 }, { 205, 0, 205 }, { 0, 205, 205 }, { 229, 229, 229 },
+		{ 127, 127, 127 }, { 255, 0, 0 }, { 0, 255, 0 }, { 255, 255, 0 }, { 92, 92, 255 }, { 255, 0, 255 }, { 0, 255, 255 }, { 255, 255, 255 },
+	};
+
+	if (index < 16)
+	{
+		return BASIC_COLORS[index];
+	}
+
+	// The 6x6x6 color cube, then 24 shades of gray.
+	if (index < 232)
+	{
+		index -= 16;
+		return { CUBE_LEVELS[index / 36], CUBE_LEVELS[index / 6 % 6], CUBE_LEVELS[index % 6] };
+	}
+
+	int gray = 8 + (index - 232) * 10;
+	return { gray, gray, gray };
+}
+
+TerminalColorEncoder::TerminalColorEncoder(TerminalColorDepth depth)
+	: m_Depth(depth)
+{
+	// The tables are computed here and not during the first frame.
+	GetColorTables();
+}
+
+void TerminalColorEncoder::SetDepth(TerminalColorDepth depth)
+{
+	m_Depth = depth;
+	this->Reset();
+}
+
+void TerminalColorEncoder::WriteForeground(TerminalColor color, std::string& output)
+{
+	this->Write(color, false, m_Foreground, output);
+}
+
+void TerminalColorEncoder::WriteBackground(TerminalColor color, std::string& output)
+{
+	this->Write(color, true, m_Background, output);
+}
+
+void TerminalColorEncoder::Reset()
+{
+	m_Foreground = -1;
+	m_Background = -1;
+}
+
+void TerminalColorEncoder::Write(TerminalColor color, bool background, int32_t& current, std::string& output)
+{
+	color = { ClampChannel(color.r), ClampChannel(color.g), ClampChannel(color.b) };
+
+	// The code of the true color, the palettes replace it.
+	int32_t encoded = color.r << 16 | color.g << 8 | color.b;
+	switch (m_Depth)
+	{
+	case TerminalColorDepth::TRUE_COLOR:
+		break;
+	case TerminalColorDepth::COLORS_256:
+		encoded = GetColorTables().GetPaletteIndex(color);
+		break;
+	case TerminalColorDepth::COLORS_16:
+		encoded = GetColorTables().basicColor[GetColorTables().GetPaletteIndex(color)];
+		break;
+	}
+
+	if (encoded == current)
+	{
+		return;
+	}
+	current = encoded;
+
+	output += "\x1b[";
+	if (m_Depth == TerminalColorDepth::TRUE_COLOR)
+	{
+		output += background ? "48;2;" : "38;2;";
+		AppendNumber(output, color.r);
+		output += ';';
+		AppendNumber(output, color.g);
+		output += ';';
+		AppendNumber(output, color.b);
+	}
+	else if (encoded < 8)
+	{
+		// ESC [ 3n m and ESC [ 4n m.
+		output += background ? '4' : '3';
+		output += static_cast<char>('0' + encoded);
+	}
+	else if (encoded < 16)
+	{
+		// The bright colors: ESC [ 9n m and ESC [ 10n m.
+		output += background ? "10" : "9";
+		output += static_cast<char>('0' + encoded - 8);
+	}
+	else
+	{
+		output += background ? "48;5;" : "38;5;";
+		AppendNumber(output, encoded);
+	}
+	output += 'm';
+}
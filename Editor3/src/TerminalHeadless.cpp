@@ -0,0 +1,475 @@
+/*
+ * TerminalHeadless.cpp - a terminal in memory for benchmarks and tests.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <TerminalHeadless.hpp>
+
+#include <stdio.h>
+
+HeadlessTerminal::HeadlessTerminal(TerminalCoord size)
+	: m_Size(size),
+	  m_Cells(size.x * size.y)
+{}
+
+void HeadlessTerminal::SetSize(TerminalCoord size)
+{
+	std::vector<HeadlessCell> cells(size.x * size.y);
+	for (int y = 0; y < size.y && y < m_Size.y; y++)
+	{
+		for (int x = 0; x < size.x && x < m_Size.x; x++)
+		{
+			cells[y * size.x + x] = m_Cells[y * m_Size.x + x];
+		}
+	}
+
+	m_Cells = std::move(cells);
+	m_Size = size;
+	m_Cursor.x = m_Cursor.x < size.x ? m_Cursor.x : size.x - 1;
+	m_Cursor.y = m_Cursor.y < size.y ? m_Cursor.y : size.y - 1;
+	m_WrapPending = false;
+}
+
+void HeadlessTerminal::PushKey(TerminalKey key)
+{
+	m_Keys.push_back(key);
+}
+
+void HeadlessTerminal::PushText(const std::string& text)
+{
+	for (char ch : text)
+	{
+		m_Keys.push_back(TerminalKey(ch, false, false));
+	}
+}
+
+std::string HeadlessTerminal::GetRowText(int y) const
+{
+	std::string text(m_Size.x, ' ');
+	for (int x = 0; x < m_Size.x; x++)
+	{
+		text[x] = m_Cells[y * m_Size.x + x].character;
+	}
+	return text;
+}
+
+void HeadlessTerminal::ClearFrameBytes()
+{
+	m_FrameBytes.clear();
+}
+
+const TerminalCoord HeadlessTerminal::GetSize()
+{
+	return m_Size;
+}
+
+void HeadlessTerminal::EnableFeature(TerminalFeature feature)
+{}
+
+void HeadlessTerminal::DisableFeature(TerminalFeature feature)
+{}
+
+void HeadlessTerminal::SetReadTimeout(int timeout)
+{}
+
+const TerminalCoord HeadlessTerminal::GetCursorPosition()
+{
+	return m_Cursor;
+}
+
+TerminalKey HeadlessTerminal::WaitAndReadKey()
+{
+	if (m_Keys.empty())
+	{
+		throw UnrecoverableTerminalImplementationError("there are no more scripted keys");
+	}
+
+	TerminalKey key = m_Keys.front();
+	m_Keys.pop_front();
+	return key;
+}
+
+bool HeadlessTerminal::WaitForKey(int timeout)
+{
+	return !m_Keys.empty();
+}
+
+void HeadlessTerminal::Flush()
+{
+	m_FrameBytes.push_back(m_Output.size());
+	if (m_GridEnabled)
+	{
+		for (char ch : m_Output)
+		{
+			this->Parse(ch);
+		}
+
+		// The strings keep their capacity, so the frames do not allocate.
+		m_LastFrame.assign(m_Output);
+	}
+	m_Output.clear();
+}
+
+int HeadlessTerminal::GetOutputDelay()
+{
+	return 0;
+}
+
+void HeadlessTerminal::WaitForOutput()
+{}
+
+void HeadlessTerminal::ClearScreen()
+{
+	m_Output += "\x1b[2J";
+}
+
+void HeadlessTerminal::ClearCurrentRow()
+{
+	m_Output += "\x1b[K";
+}
+
+void HeadlessTerminal::RevertAllAttributes()
+{
+	m_Output += "\x1b[m";
+	m_ColorEncoder.Reset();
+}
+
+void HeadlessTerminal::SetCursorPosition(TerminalCoord coord)
+{
+	char buffer[32];
+	int result = snprintf(buffer, sizeof(buffer), "\x1b[%d;%dH", coord.y + 1, coord.x + 1);
+	m_Output.append(buffer, result);
+}
+
+void HeadlessTerminal::HideCursor()
+{
+	m_Output += "\x1b[?25l";
+}
+
+void HeadlessTerminal::ShowCursor()
+{
+	m_Output += "\x1b[?25h";
+}
+
+void HeadlessTerminal::WriteCharacter(char character)
+{
+	m_Output += character;
+}
+
+void HeadlessTerminal::WriteString(const std::string& str)
+{
+	m_Output += str;
+}
+
+void HeadlessTerminal::WriteString(const std::string& str, size_t start, size_t length)
+{
+	m_Output.append(str, start, length);
+}
+
+void HeadlessTerminal::WriteCharVector(const std::vector<char>& vector)
+{
+	m_Output.append(vector.data(), vector.size());
+}
+
+void HeadlessTerminal::WriteCharVector(const std::vector<char>& vector, size_t start, size_t length)
+{
+	m_Output.append(vector.data() + start, length);
+}
+
+void HeadlessTerminal::WriteChars(const char* chars, size_t count)
+{
+	m_Output.append(chars, count);
+}
+
+void HeadlessTerminal::SetForegroundColor(TerminalColor color)
+{
+	m_ColorEncoder.WriteForeground(color, m_Output);
+}
+
+void HeadlessTerminal::SetBackgroundColor(TerminalColor color)
+{
+	m_ColorEncoder.WriteBackground(color, m_Output);
+}
+
+void HeadlessTerminal::Parse(char ch)
+{
+	switch (m_State)
+	{
+	case ParserState::GROUND:
+		if (ch == '\x1b')
+		{
+			m_State = ParserState::ESCAPE;
+		}
+		else if (ch == '\r')
+		{
+			m_Cursor.x = 0;
+			m_WrapPending = false;
+		}
+		else if (ch == '\n')
+		{
+			this->LineFeed();
+		}
+		else if (static_cast<unsigned char>(ch) >= ' ')
+		{
+			this->Print(ch);
+		}
+		break;
+	case ParserState::ESCAPE:
+		if (ch == '[')
+		{
+			m_State = ParserState::CSI;
+			m_ParameterCount = 0;
+			m_PrivateSequence = false;
+		}
+		else
+		{
+			// The other escape sequences are not used by the editor.
+			m_State = ParserState::GROUND;
+		}
+		break;
+	case ParserState::CSI:
+		if (ch == '?')
+		{
+			m_PrivateSequence = true;
+		}
+		else if (ch >= '0' && ch <= '9')
+		{
+			if (m_ParameterCount == 0)
+			{
+				m_Parameters[m_ParameterCount++] = 0;
+			}
+			int& parameter = m_Parameters[m_ParameterCount - 1];
+			parameter = parameter * 10 + (ch - '0');
+		}
+		else if (ch == ';')
+		{
+			if (m_ParameterCount == 0)
+			{
+				m_Parameters[m_ParameterCount++] = 0;
+			}
+			if (m_ParameterCount < MAX_PARAMETERS)
+			{
+				m_Parameters[m_ParameterCount++] = 0;
+			}
+		}
+		else if (ch >= '@' && ch <= '~')
+		{
+			this->ExecuteSequence(ch);
+			m_State = ParserState::GROUND;
+		}
+		break;
+	}
+}
+
+int HeadlessTerminal::GetParameter(int index, int value) const
+{
+	return index < m_ParameterCount && m_Parameters[index] != 0 ? m_Parameters[index] : value;
+}
+
+void HeadlessTerminal::ExecuteSequence(char final)
+{
+	switch (final)
+	{
+	case 'H':
+	case 'f':
+	{
+		int y = this->GetParameter(0, 1) - 1;
+		int x = this->GetParameter(1, 1) - 1;
+		m_Cursor.y = y < m_Size.y ? y : m_Size.y - 1;
+		m_Cursor.x = x < m_Size.x ? x : m_Size.x - 1;
+		m_WrapPending = false;
+		break;
+	}
+	case 'A':
+		m_Cursor.y -= this->GetParameter(0, 1);
+		m_Cursor.y = m_Cursor.y < 0 ? 0 : m_Cursor.y;
+		m_WrapPending = false;
+		break;
+	case 'B':
+		m_Cursor.y += this->GetParameter(0, 1);
+		m_Cursor.y = m_Cursor.y < m_Size.y ? m_Cursor.y : m_Size.y - 1;
+		m_WrapPending = false;
+		break;
+	case 'C':
+		m_Cursor.x += this->GetParameter(0, 1);
+		m_Cursor.x = m_Cursor.x < m_Size.x ? m_Cursor.x : m_Size.x - 1;
+		m_WrapPending = false;
+		break;
+	case 'D':
+		m_Cursor.x -= this->GetParameter(0, 1);
+		m_Cursor.x = m_Cursor.x < 0 ? 0 : m_Cursor.x;
+		m_WrapPending = false;
+		break;
+	case 'K':
+		if (this->GetParameter(0, 0) == 0)
+		{
+			this->ClearCells(m_Cursor.y, m_Cursor.x, m_Size.x);
+		}
+		else if (this->GetParameter(0, 0) == 1)
+		{
+			this->ClearCells(m_Cursor.y, 0, m_Cursor.x + 1);
+		}
+		else
+		{
+			this->ClearCells(m_Cursor.y, 0, m_Size.x);
+		}
+		break;
+	case 'J':
+	{
+		int mode = this->GetParameter(0, 0);
+		int first = mode == 0 ? m_Cursor.y + 1 : 0;
+		int last = mode == 1 ? m_Cursor.y : m_Size.y;
+		if (mode == 0)
+		{
+			this->ClearCells(m_Cursor.y, m_Cursor.x, m_Size.x);
+		}
+		else if (mode == 1)
+		{
+			this->ClearCells(m_Cursor.y, 0, m_Cursor.x + 1);
+		}
+		for (int y = first; y < last; y++)
+		{
+			this->ClearCells(y, 0, m_Size.x);
+		}
+		break;
+	}
+	case 'm':
+		this->ExecuteGraphicRendition();
+		break;
+	case 'h':
+	case 'l':
+		if (m_PrivateSequence && this->GetParameter(0, 0) == 25)
+		{
+			m_CursorVisible = final == 'h';
+		}
+		break;
+	default:
+		// The other sequences do not change the screen.
+		break;
+	}
+}
+
+void HeadlessTerminal::ExecuteGraphicRendition()
+{
+	HeadlessCell defaults;
+	if (m_ParameterCount == 0)
+	{
+		m_Attributes = defaults;
+		return;
+	}
+
+	for (int i = 0; i < m_ParameterCount; i++)
+	{
+		int parameter = m_Parameters[i];
+		if (parameter == 0)
+		{
+			m_Attributes = defaults;
+		}
+		else if (parameter == 38 || parameter == 48)
+		{
+			// The extended colors: 38;2;r;g;b or 38;5;index.
+			TerminalColor color = parameter == 38 ? defaults.foreground : defaults.background;
+			if (i + 4 < m_ParameterCount && m_Parameters[i + 1] == 2)
+			{
+				color = { m_Parameters[i + 2], m_Parameters[i + 3], m_Parameters[i + 4] };
+				i += 4;
+			}
+			else if (i + 2 < m_ParameterCount && m_Parameters[i + 1] == 5)
+			{
+				color = GetPaletteColor(m_Parameters[i + 2] & 0xFF);
+				i += 2;
+			}
+			else
+			{
+				break;
+			}
+			(parameter == 38 ? m_Attributes.foreground : m_Attributes.background) = color;
+		}
+		else if (parameter >= 30 && parameter <= 37)
+		{
+			m_Attributes.foreground = GetPaletteColor(parameter - 30);
+		}
+		else if (parameter >= 90 && parameter <= 97)
+		{
+			m_Attributes.foreground = GetPaletteColor(parameter - 90 + 8);
+		}
+		else if (parameter >= 40 && parameter <= 47)
+		{
+			m_Attributes.background = GetPaletteColor(parameter - 40);
+		}
+		else if (parameter >= 100 && parameter <= 107)
+		{
+			m_Attributes.background = GetPaletteColor(parameter - 100 + 8);
+		}
+		else if (parameter == 39)
+		{
+			m_Attributes.foreground = defaults.foreground;
+		}
+		else if (parameter == 49)
+		{
+			m_Attributes.background = defaults.background;
+		}
+	}
+}
+
+void HeadlessTerminal::Print(char ch)
+{
+	if (m_Size.x == 0 || m_Size.y == 0)
+	{
+		return;
+	}
+
+	if (m_WrapPending)
+	{
+		m_Cursor.x = 0;
+		this->LineFeed();
+	}
+
+	HeadlessCell& cell = m_Cells[m_Cursor.y * m_Size.x + m_Cursor.x];
+	cell = m_Attributes;
+	cell.character = ch;
+
+	// Like a real terminal, the cursor stays at the last column until the next character.
+	if (m_Cursor.x + 1 < m_Size.x)
+	{
+		m_Cursor.x++;
+	}
+	else
+	{
+		m_WrapPending = true;
+	}
+}
+
+void HeadlessTerminal::LineFeed()
+{
+	m_WrapPending = false;
+	if (m_Size.y == 0)
+	{
+		return;
+	}
+
+	if (m_Cursor.y + 1 < m_Size.y)
+	{
+		m_Cursor.y++;
+		return;
+	}
+
+	// The screen is scrolled up by one row.
+	m_Cells.erase(m_Cells.begin(), m_Cells.begin() + m_Size.x);
+	m_Cells.resize(m_Size.x * m_Size.y);
+	this->ClearCells(m_Size.y - 1, 0, m_Size.x);
+}
+
+void HeadlessTerminal::ClearCells(int y, int from, int to)
+{
+	for (int x = from; x < to; x++)
+	{
+		HeadlessCell& cell = m_Cells[y * m_Size.x + x];
+		cell.character = ' ';
+		cell.foreground = m_Attributes.foreground;
+		cell.background = m_Attributes.background;
+	}
+}
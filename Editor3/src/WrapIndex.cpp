@@ -0,0 +1,138 @@
+/*
+ * WrapIndex.cpp - the screen lines of the rows that are wrapped at the width of a view.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <WrapIndex.hpp>
+
+int WrapIndex::GetFirstLine(int row) const
+{
+	int rowCount = this->GetRowCount();
+	if (row >= rowCount)
+	{
+		return m_LineCount + row - rowCount;
+	}
+
+	int line = 0;
+	for (int i = row; i > 0; i -= i & -i)
+	{
+		line += m_Tree[i];
+	}
+	return line;
+}
+
+int WrapIndex::FindRow(int line) const
+{
+	if (line >= m_LineCount)
+	{
+		return this->GetRowCount() + line - m_LineCount;
+	}
+
+	// The greatest count of rows whose lines end not after the line. Then the line is in the next row.
+	int rowCount = this->GetRowCount();
+	int step = 1;
+	while (step * 2 <= rowCount)
+	{
+		step *= 2;
+	}
+
+	int row = 0;
+	for (; step > 0; step /= 2)
+	{
+		if (row + step <= rowCount && m_Tree[row + step] <= line)
+		{
+			row += step;
+			line -= m_Tree[row];
+		}
+	}
+	return row;
+}
+
+void WrapIndex::Assign(const std::vector<int>& widths, int width)
+{
+	m_Widths = widths;
+	m_Width = width < 1 ? 1 : width;
+	this->Build();
+}
+
+void WrapIndex::SetWidth(int width)
+{
+	width = width < 1 ? 1 : width;
+	if (width != m_Width)
+	{
+		m_Width = width;
+		this->Build();
+	}
+}
+
+bool WrapIndex::SetRowWidth(int row, int width)
+{
+	m_Widths[row] = width;
+
+	int delta = this->CountLines(width) - m_Lines[row];
+	if (delta == 0)
+	{
+		return false;
+	}
+
+	m_Lines[row] += delta;
+	m_LineCount += delta;
+	for (int i = row + 1; i < static_cast<int>(m_Tree.size()); i += i & -i)
+	{
+		m_Tree[i] += delta;
+	}
+	return true;
+}
+
+void WrapIndex::ShiftRows(int row, int count)
+{
+	if (count > 0)
+	{
+		m_Widths.insert(m_Widths.begin() + row, count, 0);
+		m_Lines.insert(m_Lines.begin() + row, count, this->CountLines(0));
+		m_LineCount += count * this->CountLines(0);
+	}
+	else
+	{
+		for (int i = row; i < row - count; i++)
+		{
+			m_LineCount -= m_Lines[i];
+		}
+		m_Widths.erase(m_Widths.begin() + row, m_Widths.begin() + row - count);
+		m_Lines.erase(m_Lines.begin() + row, m_Lines.begin() + row - count);
+	}
+	this->BuildTree(row);
+}
+
+void WrapIndex::Build()
+{
+	int rowCount = this->GetRowCount();
+	m_Lines.resize(rowCount);
+	m_LineCount = 0;
+	for (int i = 0; i < rowCount; i++)
+	{
+		m_Lines[i] = this->CountLines(m_Widths[i]);
+		m_LineCount += m_Lines[i];
+	}
+	this->BuildTree(0);
+}
+
+void WrapIndex::BuildTree(int row)
+{
+	int rowCount = this->GetRowCount();
+	m_Tree.resize(rowCount + 1);
+
+	// A node before row + 1 sums only the rows before row, so it is still correct.
+	// A node after it is its row plus its children, they are before it, so they are computed first. Every node is a child once, so it is O(n - row).
+	for (int i = row + 1; i <= rowCount; i++)
+	{
+		m_Tree[i] = m_Lines[i - 1];
+		for (int child = i - 1; child > i - (i & -i); child -= child & -child)
+		{
+			m_Tree[i] += m_Tree[child];
+		}
+	}
+}
@@ -7,9 +7,26 @@
  */
 
 #include <Terminal.hpp>
+#include <TerminalUnix.hpp>
 #include <Editor.hpp>
 
 #include <stdlib.h>
+#include <string.h>
+
+/// The time between screen refreshes while the editor has background work (in miliseconds).
+#define BACKGROUND_WORK_REFRESH_TIME 50
+/// The memory that the loaded files may use, if it is not set by the -m option (in megabytes).
+#define DEFAULT_MEMORY_BUDGET 256
+
+#define USAGE "Usage: ed3 [-m memoryBudgetInMegabytes] pathToFile..."
+
+// The editor draws on the terminal by its concrete type, so the calls of the terminal are resolved at compile time.
+// If EDITOR_VIRTUAL_TERMINAL is defined, then the calls go through the virtual interface of Terminal.
+#ifdef EDITOR_VIRTUAL_TERMINAL
+using StdTerminal = Terminal;
+#else
+using StdTerminal = UnixTerminal;
+#endif
 
 /// Enter the raw mode. May throw an UnrecoverableTerminalImplementationError.
 void EnterRawMode(std::shared_ptr<Terminal> terminal);
@@ -23,23 +40,65 @@ void Die(int status, std::shared_ptr<Terminal> terminal, const std::string& pref
 
 int main(int argc, char* argv[])
 {
-	std::shared_ptr<Terminal> terminal = CreateStdTerminal();
+	std::shared_ptr<StdTerminal> terminal = std::make_shared<UnixTerminal>();
 		
-	if (argc != 2)
+	size_t memoryBudget = DEFAULT_MEMORY_BUDGET;
+	std::vector<std::filesystem::path> filePaths;
+	for (int i = 1; i < argc; i++)
 	{
-		Die(2, terminal, "Error: wrong arguments count.\n", "Usage: ed3 pathToFile");
+		if (strcmp(argv[i], "-m") == 0)
+		{
+			char* end = nullptr;
+			long budget = i + 1 < argc ? strtol(argv[i + 1], &end, 10) : 0;
+			if (end == nullptr || *end != '\0' || budget <= 0)
+			{
+				Die(2, terminal, "Error: the memory budget should be a positive count of megabytes.\n", USAGE);
+			}
+			memoryBudget = budget;
+			i++;
+		}
+		else
+		{
+			filePaths.push_back(argv[i]);
+		}
+	}
+	
+	if (filePaths.empty())
+	{
+		Die(2, terminal, "Error: wrong arguments count.\n", USAGE);
 	}
 
 	try
 	{
-		Editor editor(argv[1]);
+		Editor editor(filePaths, memoryBudget * 1024 * 1024);
 
 		EnterRawMode(terminal);
 		
 		bool running = true;
 		while (running)
 		{
-			editor.RefreshScreen(terminal);
+			// While the output of the terminal is backed up, the frames are skipped but the keys are processed,
+			// so the next frame shows their result at once.
+			int outputDelay = terminal->GetOutputDelay();
+			if (outputDelay == 0)
+			{
+				editor.RefreshScreen(*terminal);
+			}
+
+			// The results of the background work are shown while the user does not press keys.
+			if (editor.HasBackgroundWork() || outputDelay > 0)
+			{
+				int timeout = outputDelay > 0 && outputDelay < BACKGROUND_WORK_REFRESH_TIME ? outputDelay : BACKGROUND_WORK_REFRESH_TIME;
+				if (!terminal->WaitForKey(timeout))
+				{
+					if (editor.HasBackgroundWork())
+					{
+						editor.ProcessBackgroundWork();
+					}
+					continue;
+				}
+			}
+			
 			TerminalKey pressedKey = terminal->WaitAndReadKey();
 			try
 			{
@@ -78,12 +137,16 @@ void EnterRawMode(std::shared_ptr<Terminal> terminal)
 	{
 		terminal->DisableFeature(feature);
 	}
+
+	// The answer of the terminal can be read only in the raw mode.
+	terminal->EnableFeature(TerminalFeature::SYNCHRONIZED_OUTPUT);
 }
 
 void ExitRawMode(std::shared_ptr<Terminal> terminal)
 {
 	try
 	{
+		terminal->DisableFeature(TerminalFeature::SYNCHRONIZED_OUTPUT);
 		terminal->ClearScreen();
 		terminal->Flush();
 	}
@@ -121,6 +184,7 @@ void Die(int status, std::shared_ptr<Terminal> terminal, const std::string& msg)
 	terminal->WriteString(msg);
 	terminal->WriteString("\n");
 	terminal->Flush();
+	terminal->WaitForOutput();
 
 	exit(status);
 }
@@ -134,6 +198,7 @@ void Die(int status, std::shared_ptr<Terminal> terminal, const std::string& pref
 	terminal->WriteString(postfixStr);
 	terminal->WriteString("\n");
 	terminal->Flush();
+	terminal->WaitForOutput();
 
 	exit(status);
 }
@@ -0,0 +1,60 @@
+/*
+ * RegexTest.cpp - checks the matches of the regular expressions on known lines.
+ * Copyright (C) 2022 Ruslan Popov <ruslanpopov1512@gmail.com>.
+ * 
+ * This file is a part of project Editor3. 
+ * This project is MIT licensed.
+ */
+
+#include <Regex.hpp>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/// A line and the matches that a pattern should find in it.
+struct RegexCase
+{
+	const char* pattern;
+	const char* line;
+	/// The expected matches as the pairs of start and length.
+	std::vector<LineMatch> matches;
+};
+
+static const RegexCase g_Cases[] =
+{
+	// The escape of a character in a class is the character, not the letter after '\'.
+	{ "[\\t]", "t\tt", { { 1, 1 } } },
+	{ "[x\\t]+", "at\txt", { { 2, 2 } } },
+	// A range may start and end with an escaped character.
+	{ "[\\t-\\+]", "a\tb+c", { { 1, 1 }, { 3, 1 } } },
+	{ "[\\t-x]+", "\x01\tax\x7f", { { 1, 3 } } },
+	{ "[\\d_]+", "a1_2b", { { 1, 3 } } },
+};
+
+int main()
+{
+	int failures = 0;
+	for (const RegexCase& test : g_Cases)
+	{
+		std::string line = test.line;
+		std::vector<LineMatch> matches;
+		RegexMatcher matcher(std::make_shared<Regex>(test.pattern));
+		matcher.FindAll(line.data(), line.size(), matches);
+
+		bool same = matches.size() == test.matches.size();
+		for (size_t i = 0; same && i < matches.size(); i++)
+		{
+			same = matches[i].start == test.matches[i].start && matches[i].length == test.matches[i].length;
+		}
+
+		if (!same)
+		{
+			fprintf(stderr, "'%s': %zu matches, expected %zu.\n", test.pattern, matches.size(), test.matches.size());
+			failures++;
+		}
+	}
+
+	printf("%d of %zu regex cases failed.\n", failures, sizeof(g_Cases) / sizeof(g_Cases[0]));
+	return failures == 0 ? 0 : 1;
+}
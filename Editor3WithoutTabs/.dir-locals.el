@@ -1 +0,0 @@
-((nil . ((company-clang-arguments . ("-Iinclude")))))